@@ -0,0 +1,89 @@
+// Micro-benchmark: DecimalParser vs std::stod on exchange price/size strings.
+// Usage: ./decimal_bench [capture]   where capture holds raw OKX "books" frames,
+// one per line. Without a capture a built-in sample of OKX BTC-USDT-SWAP
+// levels is used.
+#include "decimalParser.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Levels as OKX sends them: ["price", "size", "liquidated orders", "order count"]
+const char* kSampleLevels[][4] = {
+    {"97123.4", "12.53", "0", "4"},   {"97123.5", "0.01", "0", "1"},   {"97124.1", "3.2", "0", "2"},
+    {"97125", "120.07", "0", "11"},   {"97126.8", "0.5", "0", "1"},    {"97130.2", "44", "0", "6"},
+    {"97122.9", "7.81", "0", "3"},    {"97122.6", "0.33", "0", "1"},   {"97121", "215.6", "0", "19"},
+    {"97118.7", "1.04", "0", "2"},    {"97117.3", "60.2", "0", "5"},   {"97110.0", "0.02", "0", "1"},
+};
+
+// Pull every quoted numeric token out of the captured frames
+std::vector<std::string> loadCapture(const char* path) {
+    std::vector<std::string> tokens;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t pos = 0;
+        while ((pos = line.find('"', pos)) != std::string::npos) {
+            size_t end = line.find('"', pos + 1);
+            if (end == std::string::npos) break;
+            std::string token = line.substr(pos + 1, end - pos - 1);
+            if (!token.empty() && token.find_first_not_of("0123456789.") == std::string::npos) {
+                tokens.push_back(token);
+            }
+            pos = end + 1;
+        }
+    }
+    return tokens;
+}
+
+template <typename Fn>
+double nanosPerToken(const std::vector<std::string>& tokens, size_t rounds, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (const auto& token : tokens) fn(token);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(rounds * tokens.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> tokens;
+    if (argc > 1) {
+        tokens = loadCapture(argv[1]);
+        std::printf("%zu numeric tokens from %s\n", tokens.size(), argv[1]);
+    }
+    if (tokens.empty()) {
+        for (const auto& level : kSampleLevels) {
+            for (const char* field : level) tokens.emplace_back(field);
+        }
+        std::printf("%zu numeric tokens from the built-in OKX sample\n", tokens.size());
+    }
+
+    const size_t rounds = std::max<size_t>(1, 4000000 / tokens.size());
+    DecimalParser tickParser(0.1);
+    double doubleSink = 0.0;
+    int64_t tickSink = 0;
+
+    double stodNanos = nanosPerToken(tokens, rounds, [&](const std::string& token) {
+        doubleSink += std::stod(token);
+    });
+    double fromCharsNanos = nanosPerToken(tokens, rounds, [&](const std::string& token) {
+        double value = 0.0;
+        if (DecimalParser::parseDouble(token, value) == DecimalParser::Status::Ok) doubleSink += value;
+    });
+    double ticksNanos = nanosPerToken(tokens, rounds, [&](const std::string& token) {
+        int64_t ticks = 0;
+        if (tickParser.parseUnits(token, ticks) == DecimalParser::Status::Ok) tickSink += ticks;
+    });
+
+    std::printf("std::stod                  %6.1f ns/token\n", stodNanos);
+    std::printf("DecimalParser::parseDouble %6.1f ns/token  x%.2f\n", fromCharsNanos, stodNanos / fromCharsNanos);
+    std::printf("DecimalParser::parseUnits  %6.1f ns/token  x%.2f (0.1 ticks)\n", ticksNanos, stodNanos / ticksNanos);
+    std::printf("(checksum %.3f %lld)\n", doubleSink, static_cast<long long>(tickSink));
+    return 0;
+}
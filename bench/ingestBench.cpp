@@ -0,0 +1,85 @@
+// Micro-benchmark: parse + apply time per frame for the SAX ingestion path vs
+// the json DOM -> vector<vector<string>> -> pairs path main.cpp used before.
+// Build with -DBUILD_BENCHMARKS=ON and run ./ingest_bench from the build dir.
+#include "bookMessageParser.hpp"
+#include "orderbook.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+// OKX-shaped frames: 400 levels per side with the four-field level layout
+std::vector<std::string> makeFrames(size_t count, size_t depth) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> gap(1, 3);
+    std::uniform_real_distribution<double> size(0.01, 25.0);
+
+    auto price = [](int64_t tick) {
+        return std::to_string(tick / 10) + "." + std::to_string(tick % 10);
+    };
+
+    std::vector<std::string> frames;
+    int64_t midTick = 1000000;
+    for (size_t n = 0; n < count; ++n) {
+        midTick += gap(rng) - 2;
+        json asks = json::array(), bids = json::array();
+        int64_t askTick = midTick + 1, bidTick = midTick - 1;
+        for (size_t i = 0; i < depth; ++i) {
+            asks.push_back({price(askTick), std::to_string(size(rng)), "0", "3"});
+            bids.push_back({price(bidTick), std::to_string(size(rng)), "0", "2"});
+            askTick += gap(rng);
+            bidTick -= gap(rng);
+        }
+        json frame = {{"timestamp", "2024-01-01T12:00:00Z"}, {"asks", asks}, {"bids", bids}};
+        frames.push_back(frame.dump());
+    }
+    return frames;
+}
+
+// The handler body main.cpp ran before BookMessageParser
+void domIngest(OrderBook& orderbook, const std::string& message) {
+    auto data = json::parse(message);
+    std::string timestamp = data["timestamp"];
+    auto asks = data["asks"].get<std::vector<std::vector<std::string>>>();
+    auto bids = data["bids"].get<std::vector<std::vector<std::string>>>();
+    std::vector<std::pair<std::string, std::string>> askLevels;
+    std::vector<std::pair<std::string, std::string>> bidLevels;
+    for (const auto& ask : asks) askLevels.emplace_back(ask[0], ask[1]);
+    for (const auto& bid : bids) bidLevels.emplace_back(bid[0], bid[1]);
+    orderbook.update(timestamp, askLevels, bidLevels);
+}
+
+} // namespace
+
+int main() {
+    const size_t frameCount = 2000;
+    auto frames = makeFrames(frameCount, 400);
+
+    OrderBook domBook("OKX", "BTC-USDT-SWAP", 0.1);
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& frame : frames) domIngest(domBook, frame);
+    auto end = std::chrono::steady_clock::now();
+    double domMicros = std::chrono::duration<double, std::micro>(end - start).count() / frameCount;
+
+    OrderBook saxBook("OKX", "BTC-USDT-SWAP", 0.1);
+    BookMessageParser parser(saxBook);
+    for (const auto& frame : frames) parser.process(frame);
+    const auto& stats = parser.getStats();
+    double parseMicros = stats.totalParseNanos / 1000.0 / frameCount;
+    double applyMicros = stats.totalApplyNanos / 1000.0 / frameCount;
+
+    std::printf("frame size ~%zu bytes, 400x2 levels\n", frames.front().size());
+    std::printf("DOM path      %10.1f us/frame\n", domMicros);
+    std::printf("SAX path      %10.1f us/frame (parse %.1f + apply %.1f), x%.2f\n",
+                parseMicros + applyMicros, parseMicros, applyMicros, domMicros / (parseMicros + applyMicros));
+    std::printf("books agree: %s\n", domBook.getAsks().size() == saxBook.getAsks().size() &&
+                domBook.getMidPrice() == saxBook.getMidPrice() ? "yes" : "no");
+    return 0;
+}
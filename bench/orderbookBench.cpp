@@ -0,0 +1,183 @@
+// Micro-benchmark: price-ladder OrderBook vs the previous std::map-based book.
+// Build with -DBUILD_BENCHMARKS=ON and run ./orderbook_bench from the build dir.
+#include "orderbook.hpp"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Levels = std::vector<std::pair<std::string, std::string>>;
+
+// The node-based book this repo used before the ladder (including its mutex
+// per call), with asks ordered ascending so both books answer the same questions
+class MapBook {
+public:
+    void update(const Levels& asks, const Levels& bids) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        updateSide(asks_, asks);
+        updateSide(bids_, bids);
+    }
+
+    double bestAsk() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return asks_.empty() ? 0.0 : asks_.begin()->first;
+    }
+
+    std::vector<PriceLevel> asksAtDepth(size_t depth) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<PriceLevel> result;
+        result.reserve(std::min(depth, asks_.size()));
+        auto it = asks_.begin();
+        for (size_t i = 0; i < depth && it != asks_.end(); ++i, ++it) {
+            result.emplace_back(it->first, it->second);
+        }
+        return result;
+    }
+
+    double volumeBetween(double lower, double upper) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        double total = 0.0;
+        for (const auto& [price, quantity] : asks_) {
+            if (price >= lower && price <= upper) total += quantity;
+        }
+        for (const auto& [price, quantity] : bids_) {
+            if (price >= lower && price <= upper) total += quantity;
+        }
+        return total;
+    }
+
+    // Walk asks from the touch until quantity is filled (the pre-index approach)
+    double sweepAsks(double quantity) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        double filled = 0.0;
+        for (const auto& [price, levelQuantity] : asks_) {
+            filled += levelQuantity;
+            if (filled >= quantity) return price;
+        }
+        return 0.0;
+    }
+
+private:
+    std::map<double, double> asks_;
+    std::map<double, double, std::greater<double>> bids_;
+    mutable std::mutex mutex_;
+
+    template <typename Side>
+    static void updateSide(Side& side, const Levels& levels) {
+        side.clear();
+        for (const auto& level : levels) {
+            double quantity = std::stod(level.second);
+            if (quantity > 0) side[std::stod(level.first)] = quantity;
+        }
+    }
+};
+
+// Deep BTC-USDT-SWAP style snapshots: 400 levels per side, 0.1 tick, small gaps
+std::vector<std::pair<Levels, Levels>> makeSnapshots(size_t count, size_t depth) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> gap(1, 3);
+    std::uniform_real_distribution<double> size(0.01, 25.0);
+
+    std::vector<std::pair<Levels, Levels>> snapshots;
+    int64_t midTick = 1000000;  // 100000.0
+    for (size_t n = 0; n < count; ++n) {
+        midTick += gap(rng) - 2;
+        Levels asks, bids;
+        int64_t askTick = midTick + 1, bidTick = midTick - 1;
+        for (size_t i = 0; i < depth; ++i) {
+            asks.emplace_back(std::to_string(askTick / 10) + "." + std::to_string(askTick % 10), std::to_string(size(rng)));
+            bids.emplace_back(std::to_string(bidTick / 10) + "." + std::to_string(bidTick % 10), std::to_string(size(rng)));
+            askTick += gap(rng);
+            bidTick -= gap(rng);
+        }
+        snapshots.emplace_back(std::move(asks), std::move(bids));
+    }
+    return snapshots;
+}
+
+double nanosPerOp(size_t ops, const std::function<void()>& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(ops);
+}
+
+void report(const char* name, double mapNanos, double ladderNanos) {
+    std::printf("%-28s map %10.1f ns   ladder %10.1f ns   x%.2f\n",
+                name, mapNanos, ladderNanos, mapNanos / ladderNanos);
+}
+
+} // namespace
+
+int main() {
+    const size_t snapshotCount = 2000;
+    const size_t queryCount = 200000;
+    auto snapshots = makeSnapshots(snapshotCount, 400);
+
+    MapBook mapBook;
+    OrderBook ladderBook("OKX", "BTC-USDT-SWAP", 0.1);
+    double sink = 0.0;
+
+    double mapUpdate = nanosPerOp(snapshotCount, [&] {
+        for (const auto& [asks, bids] : snapshots) mapBook.update(asks, bids);
+    });
+    double ladderUpdate = nanosPerOp(snapshotCount, [&] {
+        for (const auto& [asks, bids] : snapshots) ladderBook.update("2024-01-01T12:00:00Z", asks, bids);
+    });
+    report("update (400x2 levels)", mapUpdate, ladderUpdate);
+
+    double mapBest = nanosPerOp(queryCount, [&] {
+        for (size_t i = 0; i < queryCount; ++i) sink += mapBook.bestAsk();
+    });
+    double ladderBest = nanosPerOp(queryCount, [&] {
+        for (size_t i = 0; i < queryCount; ++i) sink += ladderBook.getBestAsk()->price;
+    });
+    report("getBestAsk", mapBest, ladderBest);
+
+    double mapDepth = nanosPerOp(queryCount, [&] {
+        for (size_t i = 0; i < queryCount; ++i) sink += mapBook.asksAtDepth(10).back().quantity;
+    });
+    double ladderDepth = nanosPerOp(queryCount, [&] {
+        for (size_t i = 0; i < queryCount; ++i) sink += ladderBook.getAsksAtDepth(10).back().quantity;
+    });
+    report("getAsksAtDepth(10)", mapDepth, ladderDepth);
+
+    double lower = ladderBook.getMidPrice() - 50.0;
+    double upper = ladderBook.getMidPrice() + 50.0;
+    const size_t rangeCount = queryCount / 10;
+    double mapRange = nanosPerOp(rangeCount, [&] {
+        for (size_t i = 0; i < rangeCount; ++i) sink += mapBook.volumeBetween(lower, upper);
+    });
+    double ladderRange = nanosPerOp(rangeCount, [&] {
+        for (size_t i = 0; i < rangeCount; ++i) sink += ladderBook.getVolumeBetweenPrices(lower, upper);
+    });
+    report("getVolumeBetweenPrices", mapRange, ladderRange);
+
+    // Dozens of order sizes per tick, as pre-trade tooling asks them
+    std::vector<double> sweepSizes(32), sweepPrices(32);
+    for (size_t i = 0; i < sweepSizes.size(); ++i) sweepSizes[i] = 5.0 * static_cast<double>(i + 1);
+    const size_t sweepRounds = queryCount / 100;
+    const size_t sweepOps = sweepRounds * sweepSizes.size();
+    double mapSweep = nanosPerOp(sweepOps, [&] {
+        for (size_t r = 0; r < sweepRounds; ++r) {
+            for (double quantity : sweepSizes) sink += mapBook.sweepAsks(quantity);
+        }
+    });
+    double ladderSweep = nanosPerOp(sweepOps, [&] {
+        for (size_t r = 0; r < sweepRounds; ++r) {
+            ladderBook.getSweepPrices(BookSide::Ask, sweepSizes.data(), sweepPrices.data(), sweepSizes.size());
+            sink += sweepPrices.back();
+        }
+    });
+    report("sweep price (32 sizes)", mapSweep, ladderSweep);
+
+    std::printf("(checksum %.3f)\n", sink);
+    return 0;
+}
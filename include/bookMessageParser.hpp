@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include "orderbook.hpp"
+
+// Streams raw WebSocket frames straight into an OrderBook. The frame is walked
+// once with a SAX parser and levels land in scratch buffers that are reused
+// across messages, so steady-state ingestion does not allocate per level.
+//
+// With conflation enabled, process() only stages frames and flush() applies
+// them: a snapshot supersedes everything staged before it, and deltas are
+// merged so each level is written once with its latest quantity.
+//
+// Trade frames (OKX "trades" channel: objects with "sz" and "ts") never touch
+// the book; each trade is passed to the trade handler, if one is set. A trade
+// object without its own "ts" is dropped and counted, never given another's.
+class BookMessageParser {
+public:
+    // quantity, exchange time in seconds since the Unix epoch
+    using TradeHandler = std::function<void(double quantity, double timeStamp)>;
+
+    struct Stats {
+        uint64_t messages = 0;
+        uint64_t errors = 0;
+        uint64_t ignored = 0;            // Well-formed frames without asks, bids or trades (acks, events)
+        uint64_t trades = 0;             // Trades passed to the trade handler
+        uint64_t droppedTrades = 0;      // Trade objects without a usable "ts" of their own
+        uint64_t conflatedMessages = 0;  // Frames folded into a later one instead of applied
+        int64_t lastParseNanos = 0;   // SAX walk + numeric conversion
+        int64_t lastApplyNanos = 0;   // OrderBook update
+        int64_t totalParseNanos = 0;
+        int64_t totalApplyNanos = 0;
+    };
+
+    explicit BookMessageParser(OrderBook& orderbook);
+    ~BookMessageParser();
+
+    // Parse one frame and apply it to the book (or stage it when conflating).
+    // Returns false (and leaves the book untouched) if the frame is malformed
+    // or carries no asks or bids; the two cases are counted separately.
+    bool process(const std::string& frame);
+
+    // Receive the trades found in trade frames (called from process())
+    void setTradeHandler(TradeHandler handler) { tradeHandler_ = std::move(handler); }
+
+    // Opt-in conflation for consumers that fall behind the feed
+    void setConflation(bool enabled);
+    bool isConflating() const { return conflate_; }
+
+    // Apply everything staged since the last flush. Returns false if nothing was staged.
+    bool flush();
+
+    // Parse and apply timings, cumulative since construction
+    const Stats& getStats() const { return stats_; }
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+    OrderBook& orderbook_;
+    Stats stats_;
+    bool conflate_ = false;
+    TradeHandler tradeHandler_;
+
+    void recordApply(std::chrono::steady_clock::time_point start);
+};
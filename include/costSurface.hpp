@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "seqLock.hpp"
+
+// Precomputed expected cost over an order size x time horizon grid, both axes
+// log-spaced. The cost is held as two parts refreshed independently, each
+// from its own inputs: a row of horizon-free cost per size (slippage, fees)
+// and a grid of horizon-dependent cost (the execution schedule). A lookup
+// interpolates each part in log cost on log-log axes and adds them; where a
+// corner is zero or negative it has no log, and that part is interpolated
+// linearly in cost instead.
+//
+// One thread (the feed) configures the grid and publishes refreshed values;
+// lookup() may run on any number of threads without locks. Cells live in
+// fixed-capacity storage and follow the SeqLock protocol: a reader copies
+// only the four cells it needs and retries if a publish overlapped.
+class CostSurface {
+public:
+    static constexpr size_t kMaxSizes = 64;
+    static constexpr size_t kMaxHorizons = 32;
+
+    struct Config {
+        size_t sizeCount = 32;
+        double minSize = 1e-5;
+        double maxSize = 10.0;
+        size_t horizonCount = 16;
+        double minHorizon = 1.0;        // Seconds
+        double maxHorizon = 3600.0;
+        double refreshThreshold = 1e-3; // Relative input change that triggers a refresh
+        double maxAge = 60.0;           // Seconds after which the grid is refreshed regardless
+    };
+
+    enum class Part { Row, Grid };
+    static constexpr size_t kPartCount = 2;
+
+    // Model inputs a part was computed from; a refresh of that part is due
+    // once any of them moves by more than refreshThreshold relative to its
+    // last refresh. Unused trailing inputs are left at 0.
+    static constexpr size_t kInputCount = 4;
+    using Inputs = std::array<double, kInputCount>;
+
+    struct Stats {
+        uint64_t rowRefreshes = 0;
+        uint64_t gridRefreshes = 0;
+        uint64_t skippedRefreshes = 0;  // Checks that found a part still fresh
+        double lastRefreshTime = 0.0;   // Seconds, clock of the caller
+        double lastRefreshMicros = 0.0; // Time spent computing the last refreshed part
+        double age = 0.0;               // Seconds since the older part was refreshed, at the last checks
+        double inputDrift = 0.0;        // Largest relative input change at the last checks
+        size_t sizeCount = 0;
+        size_t horizonCount = 0;
+    };
+
+    CostSurface();
+
+    // Writer side. Counts are clamped to [2, kMax*]; the grid is empty until
+    // the next publish.
+    void configure(const Config& config);
+    const Config& config() const { return config_; }
+
+    // Axis values, for computing a refresh (sizes fastest within a horizon)
+    const std::vector<double>& sizes() const { return sizes_; }
+    const std::vector<double>& horizons() const { return horizons_; }
+
+    // Whether a part should be recomputed for these inputs at timeStamp;
+    // records age, drift and skipped checks in the stats
+    bool needsRefresh(Part part, const Inputs& inputs, double timeStamp);
+
+    // Store a part: sizeCount costs for the row, sizeCount x horizonCount
+    // costs (row-major by horizon) for the grid. Only that part's cells change.
+    void publish(Part part, const double* costs, const Inputs& inputs, double timeStamp, double elapsedMicros);
+
+    // Reader side, lock-free. Sizes and horizons outside the grid are clamped
+    // to its edges; the sign of size is ignored. NaN until both parts are published.
+    double lookup(double size, double horizon) const;
+
+    Stats stats() const { return stats_.load(); }
+
+private:
+    Config config_;
+    std::vector<double> sizes_;
+    std::vector<double> horizons_;
+    std::array<Inputs, kPartCount> inputs_{};
+    std::array<bool, kPartCount> published_{};
+    std::array<double, kPartCount> refreshTimes_{};
+    std::array<double, kPartCount> ages_{};
+    std::array<double, kPartCount> drifts_{};
+    Stats writerStats_;
+
+    // Readable copies of the layout and the cells, guarded by sequence_
+    alignas(64) std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> sizeCount_{0};
+    std::atomic<uint64_t> horizonCount_{0};
+    std::atomic<double> logMinSize_{0.0};
+    std::atomic<double> logSizeStep_{1.0};
+    std::atomic<double> logMinHorizon_{0.0};
+    std::atomic<double> logHorizonStep_{1.0};
+    std::atomic<bool> rowValid_{false};
+    std::atomic<bool> gridValid_{false};
+    // Cost and log cost (NaN where the cost is not positive) of each cell
+    std::array<std::atomic<double>, kMaxSizes> rowCosts_;
+    std::array<std::atomic<double>, kMaxSizes> rowLogCosts_;
+    std::array<std::atomic<double>, kMaxSizes * kMaxHorizons> gridCosts_;
+    std::array<std::atomic<double>, kMaxSizes * kMaxHorizons> gridLogCosts_;
+
+    SeqLock<Stats> stats_;
+
+    void beginWrite();
+    void endWrite();
+    void storeStats();
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// Locale-free parser for exchange price/size strings ("97123.4", "0.015").
+// Nothing here throws: failures are reported through Status so malformed
+// levels can be skipped inside the ingestion loop.
+class DecimalParser {
+public:
+    enum class Status {
+        Ok,
+        Empty,
+        Invalid,     // Not a plain decimal number
+        OutOfRange   // Does not fit the destination type
+    };
+
+    // increment is the instrument's tick size (for prices) or lot size (for quantities)
+    explicit DecimalParser(double increment);
+
+    // Parse to a double using std::from_chars (accepts exponents as well;
+    // "nan" and "inf" are Invalid)
+    static Status parseDouble(std::string_view text, double& value);
+
+    // Parse straight to a whole number of increments, rounding half away from
+    // zero when the text is not an exact multiple. Exponents are not accepted.
+    Status parseUnits(std::string_view text, int64_t& units) const;
+
+    double getIncrement() const { return increment_; }
+
+private:
+    double increment_;
+    int decimals_;              // Fractional digits needed to write increment_ exactly
+    int64_t incrementScaled_;   // increment_ * 10^decimals_
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Almgren-Chriss expected cost and variance over a risk aversion x horizon
+// grid. Everything lives in one flat buffer, structure-of-arrays:
+//
+//   riskAversions[R] | horizons[H] | expectedCosts[H*R] | variances[H*R] | kappas[H*R]
+//
+// Cell (h, r) is at index h * R + r, so each horizon's frontier is contiguous.
+class EfficientFrontier {
+public:
+    EfficientFrontier() = default;
+    EfficientFrontier(const std::vector<double>& riskAversions, const std::vector<double>& horizons);
+
+    size_t riskAversionCount() const { return riskAversionCount_; }
+    size_t horizonCount() const { return horizonCount_; }
+    size_t cellCount() const { return riskAversionCount_ * horizonCount_; }
+    size_t cellIndex(size_t horizon, size_t riskAversion) const { return horizon * riskAversionCount_ + riskAversion; }
+
+    const double* riskAversions() const { return data_.data(); }
+    const double* horizons() const { return riskAversions() + riskAversionCount_; }
+    const double* expectedCosts() const { return horizons() + horizonCount_; }
+    const double* variances() const { return expectedCosts() + cellCount(); }
+    const double* kappas() const { return variances() + cellCount(); }
+
+    double* expectedCosts() { return data_.data() + riskAversionCount_ + horizonCount_; }
+    double* variances() { return expectedCosts() + cellCount(); }
+    double* kappas() { return variances() + cellCount(); }
+
+    // The whole buffer, in the layout above
+    const std::vector<double>& buffer() const { return data_; }
+
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+
+private:
+    size_t riskAversionCount_ = 0;
+    size_t horizonCount_ = 0;
+    std::vector<double> data_;
+};
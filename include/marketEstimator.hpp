@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct MarketEstimates {
+    double ewmaVolatility = 0.0;         // Daily, EWMA of bar-close log returns
+    double parkinsonVolatility = 0.0;    // Daily, high/low range over the last rangeBars bars
+    double garmanKlassVolatility = 0.0;  // Daily, open/high/low/close over the same bars
+    double dailyVolume = 0.0;            // Traded volume per day, rolling window (0 before any trade)
+    size_t completedBars = 0;
+};
+
+// Streaming volatility and volume estimates, O(1) per tick. Mid prices are
+// grouped into fixed-length bars; traded quantity is summed over a rolling
+// window of time buckets. Volume only comes from reported trades: changes in
+// resting book quantity are mostly quotes added and cancelled, not trading.
+//
+// The EWMA of bar-close returns is the estimate to publish. The range
+// estimators (Parkinson, Garman-Klass) are reported next to it for comparison:
+// they read the high and low of the mid within each bar, which spread flicker
+// inflates, while closes a bar apart are far less exposed to that noise.
+class MarketEstimator {
+public:
+    struct Config {
+        double barSeconds = 60.0;
+        double ewmaDecay = 0.94;              // Weight of the previous variance, per bar
+        size_t rangeBars = 60;                // Bars averaged by Parkinson and Garman-Klass
+        double volumeWindowSeconds = 86400.0;
+        size_t volumeBuckets = 288;           // Resolution of the rolling volume window
+    };
+
+    MarketEstimator();
+    explicit MarketEstimator(const Config& config);
+
+    // timeStamp in seconds; ticks older than the current bar count towards it
+    void update(double midPrice, double timeStamp);
+
+    // One trade (or an aggregate of trades) of `quantity` at timeStamp seconds
+    void addTrade(double quantity, double timeStamp);
+
+    MarketEstimates estimates() const;
+    const Config& config() const { return config_; }
+    void reset();
+
+private:
+    Config config_;
+
+    // Current bar
+    bool barOpen_ = false;
+    int64_t barIndex_ = 0;
+    double open_ = 0.0, high_ = 0.0, low_ = 0.0, close_ = 0.0;
+    double previousClose_ = 0.0;
+    int64_t previousCloseBar_ = 0;
+
+    // Per-bar variances
+    size_t completedBars_ = 0;
+    size_t returnCount_ = 0;
+    double ewmaVariance_ = 0.0;
+    std::vector<double> parkinsonTerms_;
+    std::vector<double> garmanKlassTerms_;
+    size_t rangeHead_ = 0;
+    size_t rangeCount_ = 0;
+    double parkinsonSum_ = 0.0;
+    double garmanKlassSum_ = 0.0;
+
+    // Rolling volume
+    std::vector<double> volumeBuckets_;
+    double bucketSeconds_;
+    int64_t bucketIndex_ = 0;
+    double volumeSum_ = 0.0;
+    double firstTimeStamp_ = 0.0;
+    double lastTimeStamp_ = 0.0;
+    bool hasVolume_ = false;
+
+    void closeBar();
+    void pushRangeTerms(double parkinson, double garmanKlass);
+    void advanceVolumeWindow(double timeStamp);
+};
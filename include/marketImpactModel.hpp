@@ -1,10 +1,33 @@
 #pragma once
 
+#include <cstddef>
+#include <mutex>
 #include <vector>
 #include <string>
+#include "efficientFrontier.hpp"
+#include "seqLock.hpp"
+
+class ThreadPool;
+
+// Almgren-Chriss liquidation schedule over numSlices equal intervals
+struct ExecutionTrajectory {
+    std::vector<double> holdings;   // numSlices + 1 values, totalSize down to 0
+    std::vector<double> trades;     // numSlices values, quantity traded in each slice
+    double expectedCost = 0.0;      // E[cost] = gamma X^2 / 2 + (eta~ / tau) sum n_k^2
+    double variance = 0.0;          // Var[cost] = sigma^2 tau sum x_k^2
+    double kappa = 0.0;             // Urgency, per day (0 = straight line)
+};
 
 class MarketImpactModel {
 public:
+    struct Parameters {
+        double volatility = 0.0;              // Daily
+        double dailyVolume = 0.0;
+        double permanentImpactFactor = 0.1;
+        double temporaryImpactFactor = 0.1;
+        double impactExponent = 0.5;          // Power of size / dailyVolume in the temporary term
+    };
+
     MarketImpactModel();
     ~MarketImpactModel();
 
@@ -14,31 +37,111 @@ public:
                    double permanentImpactFactor = 0.1,
                    double temporaryImpactFactor = 0.1);
 
-    // Calculate market impact using Almgren-Chriss model
+    // Calculate market impact using Almgren-Chriss model:
+    // (temporary * (size / V)^impactExponent + permanent * size / V) * price
+    // Participation is against daily volume, so timeHorizon does not enter;
+    // calculateScheduleCosts prices how the horizon spreads the order out.
     double calculateMarketImpact(double orderSize,
                                double currentPrice,
                                double timeHorizon);
 
-    // Calculate optimal execution trajectory
+    // calculateMarketImpact for `count` sizes at one price, one parameter set
+    void calculateMarketImpactBatch(const double* orderSizes,
+                                    size_t count,
+                                    double currentPrice,
+                                    double* impacts) const;
+
+    static constexpr size_t kDefaultSlices = 10;
+
+    // Expected cost of trading each size evenly over its horizon (seconds) in
+    // numSlices slices, the lambda = 0 case of the schedule below:
+    // gamma X^2 (1 - 1/N) / 2 + eta X^2 / T
+    void calculateScheduleCosts(const double* orderSizes,
+                                const double* timeHorizons,
+                                size_t count,
+                                double currentPrice,
+                                double* costs,
+                                size_t numSlices = kDefaultSlices) const;
+
+    // Quantity to trade in each slice of the optimal schedule (see below)
     std::vector<double> calculateOptimalTrajectory(double totalSize,
                                                  double timeHorizon,
-                                                 double riskAversion = 0.0);
+                                                 double riskAversion = 0.0,
+                                                 size_t numSlices = kDefaultSlices) const;
+
+    // Closed-form Almgren-Chriss schedule: holdings follow
+    // x(t) = X sinh(kappa (T - t)) / sinh(kappa T). timeHorizon is in seconds;
+    // volatility is daily and dailyVolume per day. Linear impacts are
+    // gamma = permanentImpactFactor * P / V and eta = temporaryImpactFactor * P / V,
+    // so costs are in quote currency at currentPrice (relative units at 1.0)
+    // and riskAversion is per unit of that currency.
+    ExecutionTrajectory calculateExecutionTrajectory(double totalSize,
+                                                     double timeHorizon,
+                                                     double riskAversion,
+                                                     size_t numSlices = kDefaultSlices,
+                                                     double currentPrice = 1.0) const;
 
-    // Update market parameters
+    // The same for `count` risk aversions in one call, without allocating.
+    // holdings is row-major, count rows of numSlices + 1; expectedCosts and
+    // variances hold one value per risk aversion.
+    void calculateTrajectories(double totalSize,
+                               double timeHorizon,
+                               const double* riskAversions,
+                               size_t count,
+                               size_t numSlices,
+                               double currentPrice,
+                               double* holdings,
+                               double* expectedCosts,
+                               double* variances) const;
+
+    // Expected cost and variance for every (horizon, risk aversion) pair,
+    // horizons in seconds. Horizons and blocks of risk aversions are spread
+    // over `pool` when given; within a block the slices are walked for all
+    // risk aversions at once in branch-free loops the compiler vectorizes.
+    EfficientFrontier calculateEfficientFrontier(double totalSize,
+                                                 const std::vector<double>& riskAversions,
+                                                 const std::vector<double>& horizons,
+                                                 size_t numSlices = kDefaultSlices,
+                                                 double currentPrice = 1.0,
+                                                 ThreadPool* pool = nullptr) const;
+
+    // Update market parameters. Parameters are published through a sequence
+    // lock, so updates never wait for readers and readers see whole sets.
     void updateParameters(double volatility,
                          double dailyVolume,
                          double permanentImpactFactor,
                          double temporaryImpactFactor);
 
+    // Refresh volatility and daily volume, keeping the impact factors
+    void updateMarketConditions(double volatility, double dailyVolume);
+
+    // Replace the impact factors and exponent, keeping volatility and daily volume
+    void updateImpactFactors(double permanentImpactFactor, double temporaryImpactFactor, double impactExponent);
+
+    // Impact factors and exponent as key=value lines (see tools/calibrateImpact.cpp).
+    // Loading keeps volatility and daily volume, and changes nothing unless the
+    // whole file parses.
+    bool saveParameters(const std::string& filename) const;
+    bool loadParameters(const std::string& filename);
+
     // Get current parameters
+    Parameters getParameters() const { return parameters_.load(); }
     double getVolatility() const;
     double getDailyVolume() const;
     double getPermanentImpactFactor() const;
     double getTemporaryImpactFactor() const;
+    double getImpactExponent() const;
 
 private:
-    double volatility_;
-    double dailyVolume_;
-    double permanentImpactFactor_;
-    double temporaryImpactFactor_;
+    SeqLock<Parameters> parameters_;
+    std::mutex writeMutex_;   // Serializes writers of parameters_
+
+    // Per-schedule constants shared by every risk aversion
+    struct ScheduleInputs;
+    static ScheduleInputs scheduleInputs(const Parameters& parameters, double totalSize, double timeHorizon,
+                                         size_t numSlices, double currentPrice);
+    static double urgency(const ScheduleInputs& in, double riskAversion);
+    static void evaluate(const ScheduleInputs& in, double kappa, double* holdings, double& expectedCost, double& variance);
+    static void evaluateLanes(const ScheduleInputs& in, const double* kappas, size_t lanes, double* scratch,
+                              double* expectedCosts, double* variances);
 }; 
\ No newline at end of file
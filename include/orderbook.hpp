@@ -1,12 +1,19 @@
 #pragma once
 
 #include <string>
-#include <map>
+#include <array>
+#include <algorithm>
+#include <cmath>
 #include <vector>
 #include <mutex>
 #include <chrono>
 #include <optional>
 #include <memory>
+#include <cstdint>
+#include "priceLadder.hpp"
+#include "decimalParser.hpp"
+#include "timestampParser.hpp"
+#include "seqLock.hpp"
 
 struct PriceLevel {
     double price;
@@ -15,41 +22,152 @@ struct PriceLevel {
     PriceLevel(double p, double q) : price(p), quantity(q) {}
 };
 
+// A level whose price has already been converted to integer ticks
+struct TickLevel {
+    int64_t tick;
+    double quantity;
+
+    TickLevel(int64_t t, double q) : tick(t), quantity(q) {}
+};
+
+enum class BookSide { Bid, Ask };
+
+// Best levels and side totals, published together after every update
+struct TopOfBook {
+    double bidPrice = 0.0;
+    double bidQuantity = 0.0;
+    double askPrice = 0.0;
+    double askQuantity = 0.0;
+    double bidVolume = 0.0;     // Total quantity on the bid side
+    double askVolume = 0.0;     // Total quantity on the ask side
+    // Quantity in the best PriceLadder::kTrackedDepths (5, 10, 20) levels
+    std::array<double, PriceLadder::kTrackedDepths.size()> bidDepthVolume{};
+    std::array<double, PriceLadder::kTrackedDepths.size()> askDepthVolume{};
+    bool hasBid = false;
+    bool hasAsk = false;
+
+    bool isTwoSided() const { return hasBid && hasAsk; }
+    double midPrice() const { return isTwoSided() ? (askPrice + bidPrice) / 2.0 : 0.0; }
+    double spread() const { return isTwoSided() ? askPrice - bidPrice : 0.0; }
+
+    // (bid - ask) / (bid + ask) over the whole book
+    double imbalance() const { return ratio(bidVolume, askVolume); }
+
+    // Same over the best kTrackedDepths[i] levels of each side
+    double depthImbalance(size_t i) const { return ratio(bidDepthVolume[i], askDepthVolume[i]); }
+
+private:
+    static double ratio(double bid, double ask) {
+        return (bid + ask) == 0.0 ? 0.0 : (bid - ask) / (bid + ask);
+    }
+};
+
+// Consistent copy of the top levels of both sides, taken under one lock. The
+// fixed-capacity arrays keep it on the stack; levels are ordered best first.
+struct BookView {
+    static constexpr size_t kMaxDepth = 64;
+
+    struct Side {
+        size_t depth = 0;
+        std::array<double, kMaxDepth> prices;
+        std::array<double, kMaxDepth> quantities;
+        std::array<double, kMaxDepth> cumulativeQuantities;  // Sum of levels [0, i]
+
+        // Quantity in the best `levels` levels (all captured levels if fewer)
+        double totalQuantity(size_t levels) const {
+            size_t n = std::min(levels, depth);
+            return n == 0 ? 0.0 : cumulativeQuantities[n - 1];
+        }
+    };
+
+    Side bids;
+    Side asks;
+    double midPrice = 0.0;
+    double spread = 0.0;
+
+    bool isTwoSided() const { return bids.depth > 0 && asks.depth > 0; }
+
+    // (bid - ask) / (bid + ask) over the best `levels` levels of each side
+    double imbalance(size_t levels) const {
+        double bid = bids.totalQuantity(levels);
+        double ask = asks.totalQuantity(levels);
+        return (bid + ask) == 0.0 ? 0.0 : (bid - ask) / (bid + ask);
+    }
+};
+
 class OrderBook {
 public:
-    using PriceLevels = std::map<double, double, std::greater<double>>; // price -> quantity
-    using Timestamp = std::chrono::system_clock::time_point;
-    
-    OrderBook(const std::string& exchange, const std::string& symbol);
+    using Timestamp = TimestampParser::Timestamp;  // Nanosecond resolution, UTC
+
+    static constexpr double kDefaultTickSize = 0.01;
+
+    // tickSize must be the instrument's minimum price increment (or a divisor of it)
+    OrderBook(const std::string& exchange, const std::string& symbol, double tickSize = kDefaultTickSize);
     
-    // Update the orderbook with new data
+    // Update the orderbook with new data (full snapshot: replaces both sides)
     void update(const std::string& timestamp, 
                const std::vector<std::pair<std::string, std::string>>& asks,
                const std::vector<std::pair<std::string, std::string>>& bids);
+
+    // Apply an incremental update: only the listed levels change and a
+    // quantity of 0 deletes the level (OKX "books" action=update)
+    void applyDelta(const std::string& timestamp,
+                    const std::vector<std::pair<std::string, std::string>>& asks,
+                    const std::vector<std::pair<std::string, std::string>>& bids);
+
+    // Same as above for levels that were already parsed to ticks
+    void update(const std::string& timestamp,
+               const std::vector<TickLevel>& asks,
+               const std::vector<TickLevel>& bids);
+    void applyDelta(const std::string& timestamp,
+                    const std::vector<TickLevel>& asks,
+                    const std::vector<TickLevel>& bids);
     
-    // Get current top of book
+    // Consistent best bid/ask and side totals. Lock-free: readers never wait
+    // on the book mutex or block the writer.
+    TopOfBook getTopOfBook() const { return topOfBook_.load(); }
+
+    // Get current top of book (lock-free, see getTopOfBook)
     std::optional<PriceLevel> getBestAsk() const;
     std::optional<PriceLevel> getBestBid() const;
     
+    // Snapshot of the best `depth` levels per side (capped at BookView::kMaxDepth)
+    // with cumulative sums, mid and spread, all from the same book state
+    BookView view(size_t depth = BookView::kMaxDepth) const;
+
     // Get price levels at a specific depth
     std::vector<PriceLevel> getAsksAtDepth(size_t depth) const;
     std::vector<PriceLevel> getBidsAtDepth(size_t depth) const;
     
     // Get full orderbook state
-    const PriceLevels& getAsks() const { return asks_; }
-    const PriceLevels& getBids() const { return bids_; }
+    std::vector<PriceLevel> getAsks() const;
+    std::vector<PriceLevel> getBids() const;
     
-    // Get last update timestamp
-    Timestamp getLastUpdateTime() const { return lastUpdateTime_; }
+    // Get last update timestamp (exchange time from the message)
+    Timestamp getLastUpdateTime() const;
+
+    // Local receive time minus exchange time of the last message
+    std::chrono::nanoseconds getFeedLatency() const;
     
     // Get exchange and symbol
     const std::string& getExchange() const { return exchange_; }
     const std::string& getSymbol() const { return symbol_; }
+    double getTickSize() const { return tickSize_; }
+
+    // Parser converting price strings straight to ticks of this book
+    const DecimalParser& getPriceParser() const { return priceParser_; }
+
+    // Number of levels skipped because their price or quantity was malformed
+    uint64_t getParseErrorCount() const;
+
+    // Number of levels discarded for lying more than PriceLadder::kMaxSpan
+    // ticks behind the touch
+    uint64_t getDroppedLevelCount() const;
     
-    // Get mid price
+    // Get mid price (lock-free)
     double getMidPrice() const;
     
-    // Get spread
+    // Get spread (lock-free)
     double getSpread() const;
     
     // Get total volume at a specific price level
@@ -58,21 +176,48 @@ public:
     // Get total volume between two price levels
     double getVolumeBetweenPrices(double lowerPrice, double upperPrice) const;
 
-    // Get total bid and ask volume
+    // Price of the deepest level reached when taking `quantity` from the touch
+    // of `side` (Ask for a buy). nullopt if the side holds less. O(log n).
+    std::optional<double> getSweepPrice(BookSide side, double quantity) const;
+
+    // Batched form of getSweepPrice under a single lock; NaN marks sizes the
+    // side cannot fill
+    void getSweepPrices(BookSide side, const double* quantities, double* prices, size_t count) const;
+
+    // Quantity resting on `side` within `bps` basis points of the mid. O(log n).
+    double getVolumeWithinBps(BookSide side, double bps) const;
+
+    // Get total bid and ask volume (lock-free, O(1))
     double getBidVolume() const;
     double getAskVolume() const;
 
+    // Book-wide (bid - ask) / (bid + ask) volume imbalance (lock-free, O(1))
+    double getImbalance() const;
+
 private:
     std::string exchange_;
     std::string symbol_;
-    PriceLevels asks_;  // Sorted by price (ascending)
-    PriceLevels bids_;  // Sorted by price (descending)
+    double tickSize_;
+    DecimalParser priceParser_;
+    uint64_t parseErrors_ = 0;
+    PriceLadder asks_;  // Best (lowest) ask first
+    PriceLadder bids_;  // Best (highest) bid first
     Timestamp lastUpdateTime_;
-    mutable std::mutex mutex_;  // For thread safety
+    Timestamp lastReceiveTime_;
+    TimestampParser timestampParser_;
+    mutable std::mutex mutex_;  // Serializes writers and depth queries
+    SeqLock<TopOfBook> topOfBook_;
     
     // Helper functions
-    void updateSide(PriceLevels& side, const std::vector<std::pair<std::string, std::string>>& levels);
-    static double parsePrice(const std::string& price);
-    static double parseQuantity(const std::string& quantity);
-    static Timestamp parseTimestamp(const std::string& timestamp);
+    void updateSide(PriceLadder& side, const std::vector<std::pair<std::string, std::string>>& levels);
+    void applySideDelta(PriceLadder& side, const std::vector<std::pair<std::string, std::string>>& levels);
+    void updateSide(PriceLadder& side, const std::vector<TickLevel>& levels);
+    void applySideDelta(PriceLadder& side, const std::vector<TickLevel>& levels);
+    std::vector<PriceLevel> levelsAtDepth(const PriceLadder& side, size_t depth) const;
+    void fillViewSide(const PriceLadder& side, size_t depth, BookView::Side& out) const;
+    int64_t toTick(double price) const { return static_cast<int64_t>(std::llround(price / tickSize_)); }
+    double toPrice(int64_t tick) const { return static_cast<double>(tick) * tickSize_; }
+    bool parseLevel(const std::pair<std::string, std::string>& level, int64_t& tick, double& quantity);
+    void stampUpdate(const std::string& timestamp);
+    void publishTopOfBook();
 }; 
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3"). Each (key, counter) pair maps to four
+// independent 32-bit words, so any thread can draw the numbers for any path
+// and step directly: results do not depend on how work is split.
+class Philox4x32 {
+public:
+    using Counter = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+    static Key keyFromSeed(uint64_t seed) {
+        return {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+    }
+
+    static Counter generate(Counter counter, Key key) {
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) {
+                key[0] += kWeyl0;
+                key[1] += kWeyl1;
+            }
+            uint64_t product0 = static_cast<uint64_t>(kMultiplier0) * counter[0];
+            uint64_t product1 = static_cast<uint64_t>(kMultiplier1) * counter[2];
+            counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                       static_cast<uint32_t>(product1),
+                       static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                       static_cast<uint32_t>(product0)};
+        }
+        return counter;
+    }
+
+    // The same for `count` counters stored column-wise, overwritten with the
+    // output. Rounds run outermost so each lane loop vectorizes.
+    static void generate(uint32_t* c0, uint32_t* c1, uint32_t* c2, uint32_t* c3, size_t count, Key key) {
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) {
+                key[0] += kWeyl0;
+                key[1] += kWeyl1;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                uint64_t product0 = static_cast<uint64_t>(kMultiplier0) * c0[i];
+                uint64_t product1 = static_cast<uint64_t>(kMultiplier1) * c2[i];
+                uint32_t next0 = static_cast<uint32_t>(product1 >> 32) ^ c1[i] ^ key[0];
+                uint32_t next2 = static_cast<uint32_t>(product0 >> 32) ^ c3[i] ^ key[1];
+                c1[i] = static_cast<uint32_t>(product1);
+                c3[i] = static_cast<uint32_t>(product0);
+                c0[i] = next0;
+                c2[i] = next2;
+            }
+        }
+    }
+
+    // Uniform in (0, 1), never exactly 0 or 1
+    static double toUniform(uint32_t word) { return (static_cast<double>(word) + 0.5) * 0x1p-32; }
+
+    // Standard normal from two words (Box-Muller, cosine branch)
+    static double toNormal(uint32_t first, uint32_t second) {
+        constexpr double kTwoPi = 6.283185307179586476925286766559;
+        return std::sqrt(-2.0 * std::log(toUniform(first))) * std::cos(kTwoPi * toUniform(second));
+    }
+
+private:
+    static constexpr uint32_t kMultiplier0 = 0xD2511F53u;
+    static constexpr uint32_t kMultiplier1 = 0xCD9E8D57u;
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9u;
+    static constexpr uint32_t kWeyl1 = 0xBB67AE85u;
+};
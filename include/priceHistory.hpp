@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Fixed-capacity window of market observations, oldest overwritten first.
+// Stored as structure-of-arrays so each series is contiguous, and appending is
+// O(1) regardless of the window size. Index 0 is the oldest point.
+class PriceHistory {
+public:
+    struct Point {
+        double price;
+        double volume;
+        double timeStamp;
+    };
+
+    explicit PriceHistory(size_t capacity) { setCapacity(capacity); }
+
+    // Append a point. Returns true and fills `evicted` when the window was
+    // full and its oldest point dropped out.
+    bool push(double price, double volume, double timeStamp, Point& evicted) {
+        bool full = size_ == capacity();
+        if (full) {
+            evicted = {prices_[head_], volumes_[head_], timeStamps_[head_]};
+        }
+        prices_[head_] = price;
+        volumes_[head_] = volume;
+        timeStamps_[head_] = timeStamp;
+        if (++head_ == capacity()) head_ = 0;
+        if (!full) ++size_;
+        return full;
+    }
+
+    bool push(double price, double volume, double timeStamp) {
+        Point evicted;
+        return push(price, volume, timeStamp, evicted);
+    }
+
+    double price(size_t i) const { return prices_[slot(i)]; }
+    double volume(size_t i) const { return volumes_[slot(i)]; }
+    double timeStamp(size_t i) const { return timeStamps_[slot(i)]; }
+    Point at(size_t i) const { size_t s = slot(i); return {prices_[s], volumes_[s], timeStamps_[s]}; }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return prices_.size(); }
+    bool empty() const { return size_ == 0; }
+    bool full() const { return size_ == capacity(); }
+
+    void clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+
+    // Replace the contents with `count` points, oldest first (count <= capacity)
+    void assign(const double* prices, const double* volumes, const double* timeStamps, size_t count) {
+        count = std::min(count, capacity());
+        std::copy(prices, prices + count, prices_.begin());
+        std::copy(volumes, volumes + count, volumes_.begin());
+        std::copy(timeStamps, timeStamps + count, timeStamps_.begin());
+        size_ = count;
+        head_ = count == capacity() ? 0 : count;
+    }
+
+    // Change the window, keeping the newest points that still fit
+    void setCapacity(size_t capacity) {
+        capacity = std::max<size_t>(capacity, 1);
+        size_t keep = std::min(size_, capacity);
+        std::vector<double> prices(capacity), volumes(capacity), timeStamps(capacity);
+        for (size_t i = 0; i < keep; ++i) {
+            size_t s = slot(size_ - keep + i);
+            prices[i] = prices_[s];
+            volumes[i] = volumes_[s];
+            timeStamps[i] = timeStamps_[s];
+        }
+        prices_.swap(prices);
+        volumes_.swap(volumes);
+        timeStamps_.swap(timeStamps);
+        size_ = keep;
+        head_ = keep == capacity ? 0 : keep;
+    }
+
+private:
+    std::vector<double> prices_;
+    std::vector<double> volumes_;
+    std::vector<double> timeStamps_;
+    size_t head_ = 0;   // Next slot to write
+    size_t size_ = 0;
+
+    // Physical slot of the i-th oldest point
+    size_t slot(size_t i) const {
+        size_t start = head_ + capacity() - size_;   // Oldest point, unwrapped
+        size_t s = start + i;
+        while (s >= capacity()) s -= capacity();
+        return s;
+    }
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One side of the orderbook stored as a dense, contiguous array of quantities
+// indexed by integer price tick. Keys grow away from the touch (asks use +tick,
+// bids use -tick) so the best level is always the lowest occupied slot.
+//
+// A Fenwick tree over the slots is updated alongside every change, so
+// cumulative depth from the touch (range volume, sweep price) is O(log n).
+class PriceLadder {
+public:
+    // Maximum number of ticks kept between the best level and the deepest one
+    static constexpr int64_t kMaxSpan = int64_t(1) << 21;
+
+    // Depths (in occupied levels) whose cumulative quantity is kept up to date
+    static constexpr std::array<size_t, 3> kTrackedDepths = {5, 10, 20};
+
+    explicit PriceLadder(bool isBid);
+
+    // Set the quantity resting at a tick (quantity <= 0 removes the level)
+    void set(int64_t tick, double quantity);
+
+    // Remove all levels, keeping the allocated storage
+    void clear();
+
+    bool empty() const { return levelCount_ == 0; }
+    size_t levelCount() const { return levelCount_; }
+
+    // Best level, only valid when the ladder is not empty
+    int64_t bestTick() const { return fromKey(baseKey_ + static_cast<int64_t>(bestIndex_)); }
+    double bestQuantity() const { return quantities_[bestIndex_]; }
+
+    // Quantity resting at a tick (0 if the level is empty)
+    double quantityAt(int64_t tick) const;
+
+    // Visit up to depth occupied levels, best first, as fn(tick, quantity)
+    template <typename Fn>
+    void forEachLevel(size_t depth, Fn&& fn) const {
+        size_t visited = 0;
+        for (size_t i = bestIndex_; visited < depth && visited < levelCount_; ++i) {
+            if (quantities_[i] > 0.0) {
+                fn(fromKey(baseKey_ + static_cast<int64_t>(i)), quantities_[i]);
+                ++visited;
+            }
+        }
+    }
+
+    // Total quantity for ticks in [lowTick, highTick] (O(log n))
+    double volumeBetween(int64_t lowTick, int64_t highTick) const;
+
+    // Tick of the deepest level reached when taking `quantity` from the touch.
+    // Returns false if the side holds less than that. O(log n).
+    bool sweepTick(double quantity, int64_t& tick) const;
+
+    // Levels discarded for lying more than kMaxSpan ticks behind the touch,
+    // on arrival or when the touch moved away from them
+    uint64_t droppedLevels() const { return droppedLevels_; }
+
+    // Total quantity on this side, maintained as levels change (O(1))
+    double totalVolume() const { return totalQuantity_; }
+
+    // Quantity in the best kTrackedDepths[i] levels, valid after refreshDepthVolumes()
+    double trackedDepthVolume(size_t i) const { return depthVolumes_[i]; }
+
+    // Recompute tracked depth sums if a change touched the levels they cover.
+    // Call once after a batch of set() calls.
+    void refreshDepthVolumes();
+
+private:
+    bool isBid_;
+    int64_t baseKey_;               // key stored at quantities_[0]
+    std::vector<double> quantities_;
+    std::vector<double> fenwick_;   // fenwick_[i - 1] covers slots (i - lowbit(i), i]
+    size_t fenwickTopBit_;          // Highest power of two <= quantities_.size()
+    size_t bestIndex_;              // lowest occupied slot
+    size_t worstIndex_;             // highest occupied slot
+    size_t levelCount_;
+    double totalQuantity_;
+    std::array<double, kTrackedDepths.size()> depthVolumes_;
+    size_t depthBoundary_;          // Slot of the deepest level covered by the tracked depths
+    bool depthVolumesDirty_;
+    uint64_t droppedLevels_;
+    size_t touchedLow_;             // Slots changed since the tree was rebuilt or zeroed
+    size_t touchedHigh_;            // (empty while touchedLow_ > touchedHigh_)
+
+    int64_t toKey(int64_t tick) const { return isBid_ ? -tick : tick; }
+    int64_t fromKey(int64_t key) const { return isBid_ ? -key : key; }
+
+    // Move storage so that it starts at newBaseKey and holds newSize slots
+    void rebase(int64_t newBaseKey, size_t newSize);
+    void markDepthChange(size_t index);
+
+    void zeroTouched();
+    void rebuildFenwick();
+    void fenwickAdd(size_t index, double delta);
+    double prefixVolume(size_t index) const;          // Slots [0, index]
+    size_t lowerBound(double target) const;           // First slot whose prefix reaches target
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Quantiles of a sliding window of values, maintained as values enter and
+// leave instead of sorting the window on every query.
+//
+//  - Exact: order-statistic tree; insert/remove/query are O(log n) and the
+//    answer matches sorting the window (linear interpolation between ranks).
+//  - Approximate: P² markers for a fixed set of quantiles; insert is O(1) per
+//    tracked quantile and queries are O(1). The window is approximated by two
+//    generations of half a window each, so remove() is a no-op.
+class QuantileEstimator {
+public:
+    enum class Mode { Exact, Approximate };
+
+    static std::unique_ptr<QuantileEstimator> create(Mode mode,
+                                                     size_t windowSize,
+                                                     const std::vector<double>& trackedQuantiles);
+
+    virtual ~QuantileEstimator() = default;
+
+    virtual Mode mode() const = 0;
+
+    virtual void insert(double value) = 0;
+
+    // Drop a value previously inserted that left the window
+    virtual void remove(double value) = 0;
+
+    // Estimate of the q-quantile (q in [0, 1]); 0 when empty
+    virtual double quantile(double q) const = 0;
+
+    // Replace the contents with `count` ascending values, e.g. from a saved
+    // state. The exact tree is built in O(n); other modes insert one by one.
+    virtual void assignSorted(const double* values, size_t count) {
+        clear();
+        for (size_t i = 0; i < count; ++i) insert(values[i]);
+    }
+
+    virtual void setWindowSize(size_t windowSize) = 0;
+    virtual void clear() = 0;
+};
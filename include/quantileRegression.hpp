@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// Linear quantile regression fitted by iteratively reweighted least squares:
+// each pass solves a weighted normal-equation system whose weights approximate
+// the pinball loss, tau / |r| above the fit and (1 - tau) / |r| below it.
+class QuantileRegression {
+public:
+    // Intercept, sqrt(size / average volume), relative spread, imbalance, volatility
+    static constexpr size_t kFeatures = 5;
+    using Coefficients = std::array<double, kFeatures>;
+    using Features = std::array<double, kFeatures>;
+
+    // features holds `labels.size()` rows of kFeatures values, row-major.
+    // Returns false if there are too few rows or the system is singular.
+    bool fit(const std::vector<double>& features,
+             const std::vector<double>& labels,
+             double quantile,
+             Coefficients& coefficients);
+
+    static double predict(const Coefficients& coefficients, const Features& x) {
+        double value = 0.0;
+        for (size_t j = 0; j < kFeatures; ++j) value += coefficients[j] * x[j];
+        return value;
+    }
+
+private:
+    static constexpr int kMaxIterations = 50;
+
+    std::vector<double> weights_;   // Reused between fits
+
+    bool solveWeighted(const std::vector<double>& features,
+                       const std::vector<double>& labels,
+                       Coefficients& coefficients) const;
+};
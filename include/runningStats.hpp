@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// Welford mean/variance over a sliding window: values are added as they
+// enter and removed as they leave, so every query is O(1).
+class RunningStats {
+public:
+    void add(double x) {
+        ++count_;
+        double delta = x - mean_;
+        mean_ += delta / static_cast<double>(count_);
+        m2_ += delta * (x - mean_);
+    }
+
+    // x must be a value previously added that is still counted
+    void remove(double x) {
+        if (count_ <= 1) {
+            clear();
+            return;
+        }
+        --count_;
+        double delta = x - mean_;
+        mean_ -= delta / static_cast<double>(count_);
+        m2_ = std::max(m2_ - delta * (x - mean_), 0.0);
+    }
+
+    void clear() {
+        count_ = 0;
+        mean_ = 0.0;
+        m2_ = 0.0;
+    }
+
+    size_t count() const { return count_; }
+    double mean() const { return mean_; }
+
+    // Sample variance (n - 1), 0 with fewer than two values
+    double variance() const { return count_ > 1 ? m2_ / static_cast<double>(count_ - 1) : 0.0; }
+    double stdDev() const { return std::sqrt(variance()); }
+
+private:
+    size_t count_ = 0;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+};
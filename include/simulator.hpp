@@ -2,11 +2,20 @@
 
 #include <string>
 #include <memory>
+#include <mutex>
 #include <chrono>
+#include <array>
+#include <vector>
 #include "slippageModel.hpp"
 #include "feeModel.hpp"
 #include "marketImpactModel.hpp"
+#include "marketEstimator.hpp"
 #include "orderbook.hpp"
+#include "sweepEngine.hpp"
+#include "costSurface.hpp"
+#include "monteCarloEngine.hpp"
+
+class ThreadPool;
 
 struct TradeMetrics {
     double expectedSlippage;
@@ -39,6 +48,53 @@ struct DetailedTradeMetrics {
     double expectedFees = 0.0;
     double netCost = 0.0;
     double internalLatency = 0.0;
+
+    // Walking the captured levels for orderSize (asks for a buy, bids for a
+    // sell), next to the model estimates above
+    double sweepVwap = 0.0;
+    double sweepCost = 0.0;           // Paid beyond the mid, in quote currency
+    double sweepResidual = 0.0;       // Quantity the captured depth could not fill
+    size_t sweepLevelsConsumed = 0;
+
+    // Quantile regression of book-sweep slippage (0 until the first fit)
+    double regressionSlippage = 0.0;
+
+    // Simulated shortfall of the order over its horizon, in Monte Carlo mode
+    bool hasCostDistribution = false;
+    double costConfidence = 0.0;          // First configured level
+    double costMean = 0.0;
+    double costValueAtRisk = 0.0;
+    double costExpectedShortfall = 0.0;
+};
+
+enum class OrderSide { Buy, Sell };
+
+// Output of Simulator::calculateTradeMetricsBatch, one entry per order in
+// structure-of-arrays form. Reuse it across calls: resize() only allocates
+// when the batch grows.
+struct TradeMetricsBatch {
+    std::vector<double> expectedSlippage;
+    std::vector<double> expectedMarketImpact;   // Horizon-independent, see calculateMarketImpact
+    std::vector<double> scheduleCost;     // Almgren-Chriss cost of trading evenly over the horizon
+    std::vector<double> expectedFees;
+    std::vector<double> makerTakerRatio;
+    std::vector<double> netCost;          // Slippage + fees + impact, as in DetailedTradeMetrics
+    std::vector<double> sweepVwap;        // NaN when the captured side is empty
+    std::vector<double> sweepCost;
+    std::vector<double> sweepResidual;
+
+    // Shared by every order of the batch
+    double midPrice = 0.0;
+    double currentSpread = 0.0;
+    double orderBookImbalance = 0.0;
+
+    void resize(size_t count) {
+        for (auto* column : {&expectedSlippage, &expectedMarketImpact, &scheduleCost, &expectedFees,
+                             &makerTakerRatio, &netCost, &sweepVwap, &sweepCost, &sweepResidual}) {
+            column->resize(count);
+        }
+    }
+    size_t size() const { return netCost.size(); }
 };
 
 class Simulator {
@@ -46,20 +102,77 @@ public:
     Simulator();
     ~Simulator();
 
-    // Initialize the simulator with exchange and asset
-    void initialize(const std::string& exchange, const std::string& spotAsset);
+    // Initialize the simulator with exchange, asset and starting capital
+    void initialize(const std::string& exchange, const std::string& spotAsset, double initialCapital = 0.0);
     TradeMetrics simulateMarketOrder(double quantityUSD);
+    // Feeds the streaming volatility/volume estimators and, at most once per
+    // parameter update interval of exchange time, pushes their estimates
+    // into the market impact model, samples the book for the slippage
+    // regression and refreshes the cost surface
     void updateMarketData(const OrderBook& orderbook);
+    // Public trade from a trade feed, timeStamp in seconds of exchange time.
+    // The only source of the daily volume estimate: until trades arrive the
+    // impact model keeps its configured daily volume. Safe to call from the
+    // trade feed's thread while updateMarketData runs on another.
+    void recordTrade(double quantity, double timeStamp);
+    void setParameterUpdateInterval(double seconds);
+    // Impact factors fitted by tools/calibrateImpact (MarketImpactModel::loadParameters)
+    bool loadImpactParameters(const std::string& filename);
+    double getParameterUpdateInterval() const;
+    MarketEstimates getMarketEstimates() const;
     double getCurrentVolatility() const;
     std::string getCurrentFeeTier() const;
 
     TradeResult simulateTrade(double orderSize, double limitPrice, const std::string& orderType, double timeHorizon);
     DetailedTradeMetrics calculateTradeMetrics(double orderSize, double limitPrice, const std::string& orderType, const OrderBook& orderbook, double timeHorizon);
+    // Same metrics from an existing snapshot, without touching the orderbook.
+    // A positive orderSize buys, a negative one sells; for orderType "market"
+    // limitPrice is ignored and the order takes liquidity.
+    DetailedTradeMetrics calculateTradeMetrics(double orderSize, double limitPrice, const std::string& orderType, const BookView& view, double timeHorizon);
+    // What-if pricing of `count` orders against one consistent snapshot.
+    // orderSizes are quantities (the sign is ignored; sides give the
+    // direction). Uses the formulas of calculateTradeMetrics.
+    // The maker probability grows with how passive the limit is for its side;
+    // pass +infinity (buy) or 0 (sell) for a market order.
+    // timeHorizons price scheduleCost; expectedMarketImpact, like
+    // MarketImpactModel::calculateMarketImpact, does not depend on the horizon.
+    // Scratch space is reused between calls, so nothing is allocated per order.
+    void calculateTradeMetricsBatch(const double* orderSizes,
+                                    const OrderSide* sides,
+                                    const double* limitPrices,
+                                    const double* timeHorizons,
+                                    size_t count,
+                                    const OrderBook& orderbook,
+                                    TradeMetricsBatch& metrics);
+    void calculateTradeMetricsBatch(const double* orderSizes,
+                                    const OrderSide* sides,
+                                    const double* limitPrices,
+                                    const double* timeHorizons,
+                                    size_t count,
+                                    const BookView& view,
+                                    TradeMetricsBatch& metrics);
+    // Monte Carlo mode: calculateTradeMetrics also simulates the order's
+    // shortfall distribution with `config`, on `threads` threads (0 = all cores)
+    void enableMonteCarlo(const MonteCarloEngine::Config& config, size_t threads = 0);
+    void disableMonteCarlo();
+    // Shortfall distribution of an order over timeHorizon seconds from the
+    // current impact parameters and fee rate, with the Monte Carlo config
+    CostDistribution simulateCostDistribution(double orderSize, double timeHorizon, const BookView& view);
+
+    // Expected cost (slippage + taker fees + Almgren-Chriss schedule cost) of
+    // an order over a horizon in seconds, interpolated from the cost surface
+    // that updateMarketData refreshes. Safe from any thread; NaN until the
+    // first refresh.
+    double lookupExpectedCost(double orderSize, double timeHorizon) const;
+    void configureCostSurface(const CostSurface::Config& config);
+    CostSurface::Stats getCostSurfaceStats() const;
     double getCurrentCapital() const;
     double getCurrentPosition() const;
     double getCurrentPnL() const;
-    void saveState(const std::string& filename);
-    void loadState(const std::string& filename);
+    // Portfolio state plus the slippage model, in one versioned, checksummed
+    // binary file (see SlippageModel::saveModel). A failed load changes nothing.
+    bool saveState(const std::string& filename) const;
+    bool loadState(const std::string& filename);
 
 private:
     std::unique_ptr<SlippageModel> slippageModel_;
@@ -74,10 +187,57 @@ private:
     double currentVolatility_ = 0.0;
     std::string currentFeeTier_;
 
+    MarketEstimator marketEstimator_;
+    mutable std::mutex estimatorMutex_;   // Book and trade feeds may run on different threads
+    double parameterUpdateInterval_ = kDefaultParameterUpdateInterval;
+    double lastParameterUpdate_ = 0.0;
+    bool parametersPublished_ = false;
+
+    bool monteCarloEnabled_ = false;
+    MonteCarloEngine::Config monteCarloConfig_;
+    std::unique_ptr<ThreadPool> monteCarloPool_;
+
+    CostSurface costSurface_;
+    double lastSurfaceSample_ = 0.0;
+    bool surfaceSampled_ = false;
+    std::vector<double> surfaceSizes_;
+    std::vector<double> surfaceHorizons_;
+    std::vector<double> surfaceCosts_;
+
+    // calculateTradeMetricsBatch scratch: one side's sizes and their sweeps
+    std::vector<size_t> batchIndices_;
+    std::vector<double> batchQuantities_;
+    std::vector<double> batchVwaps_;
+    std::vector<double> batchCosts_;
+    std::vector<double> batchResiduals_;
+
+    static constexpr double kDefaultParameterUpdateInterval = 5.0;   // Seconds
+    // Bars the estimators need before their volatility replaces the default
+    static constexpr size_t kMinBarsForVolatility = 2;
+
+    // Quantile of the slippage model used for expected slippage
+    static constexpr double kSlippageConfidence = 0.95;
+    // Relative step in which the slippage scale keys the cost surface row
+    static constexpr double kSlippageScaleStep = 0.05;
+
+    // Levels per side used for the orderbook imbalance
+    static constexpr size_t kImbalanceDepth = 10;
+    // Levels per side captured for the book sweep
+    static constexpr size_t kSweepDepth = BookView::kMaxDepth;
+    // Sizes swept on each side once per parameter update interval to train the
+    // slippage regression, as fractions of that side's depth over kImbalanceDepth levels
+    static constexpr std::array<double, 5> kObservationDepthFractions = {0.05, 0.1, 0.25, 0.5, 1.0};
+
     // Helper methods
     double calculateMakerTakerProportion(const OrderBook& orderbook);
     double measureInternalLatency();
-    double calculateMakerTakerProbability(const OrderBook& orderbook, double limitPrice);
-    double calculateOrderBookImbalance(const OrderBook& orderbook);
+    double calculateMakerTakerProbability(const BookView& view, double limitPrice, OrderSide side);
+    double calculateOrderBookImbalance(const BookView& view);
     double estimateInternalLatency();
+    void publishMarketParameters(double timeStamp);
+    CostSurface::Inputs costSurfaceInputs(CostSurface::Part part, double midPrice) const;
+    void refreshCostSurface(double midPrice, double timeStamp);
+    void sweepBatchSide(const BookView& view, OrderSide side, const double* orderSizes, const OrderSide* sides,
+                        size_t count, TradeMetricsBatch& metrics);
+    void recordSweepObservations(const BookView& view);
 }; 
\ No newline at end of file
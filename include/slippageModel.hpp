@@ -1,35 +1,99 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <vector>
 #include <memory>
 #include <string>
+#include "quantileEstimator.hpp"
+#include "stateFile.hpp"
 
 class SlippageModel {
 public:
-    SlippageModel();
+    // Number of most recent data points kept by default
+    static constexpr size_t kDefaultWindowSize = 1000;
+    // Largest window accepted, from setWindowSize or a state file: about
+    // 33M points, 800 MB of history allocated up front
+    static constexpr size_t kMaxWindowSize = size_t(1) << 25;
+
+    // windowSize is clamped to kMaxWindowSize
+    explicit SlippageModel(size_t windowSize = kDefaultWindowSize);
     ~SlippageModel();
 
+    // Resize the history window, keeping the newest points that still fit.
+    // Returns false if windowSize exceeded kMaxWindowSize and was clamped to it.
+    bool setWindowSize(size_t windowSize);
+    size_t getWindowSize() const;
+
+    // Exact (order-statistic tree) or approximate (P²) return quantiles.
+    // Switching rebuilds the estimator from the current window.
+    void setQuantileMode(QuantileEstimator::Mode mode);
+    QuantileEstimator::Mode getQuantileMode() const;
+
     // Initialize the model with historical data
     void initialize(const std::vector<double>& prices, 
                    const std::vector<double>& volumes,
                    const std::vector<double>& timeStamps);
 
-    // Predict slippage using quantile regression
+    // Predict slippage at a quantile of the windowed returns. Const and
+    // lock-free: reads the snapshot published by the last update. Quantiles
+    // other than getQuantileLevels() are interpolated between those levels.
     double predictSlippage(double orderSize, 
                           double currentPrice, 
-                          double quantile = 0.95);
+                          double quantile = 0.95) const;
+
+    // predictSlippage for `count` sizes at one price from one snapshot
+    void predictSlippageBatch(const double* orderSizes,
+                              size_t count,
+                              double currentPrice,
+                              double quantile,
+                              double* slippages) const;
+
+    // Quantile levels reported by predictSlippageDistribution (0.1 ... 0.99)
+    const std::vector<double>& getQuantileLevels() const;
+
+    // Slippage at every level of getQuantileLevels() from one snapshot, in one
+    // pass; `slippages` must hold getQuantileLevels().size() values. Lock-free.
+    void predictSlippageDistribution(double orderSize, double currentPrice, double* slippages) const;
 
     // Update the model with new data point
     void update(double price, double volume, double timeStamp);
 
+    // Record a realized slippage (fraction of mid, e.g. from a book sweep) for
+    // an order of orderSize. Size ratio and volatility come from the window.
+    void addObservation(double orderSize, double relativeSpread, double imbalance, double realizedSlippage);
+
+    // Refit the quantile regression on a background thread every `interval`
+    void startFitting(std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
+    void stopFitting();
+
+    // Fit once on the calling thread; false if nothing new or the fit failed
+    bool fitRegression();
+    bool isRegressionFitted() const;
+
+    // Quantile-regression slippage estimate in price units. Lock-free and
+    // O(features); never waits on fitting. 0 until the first fit.
+    double predictRegressionSlippage(double orderSize,
+                                     double currentPrice,
+                                     double relativeSpread,
+                                     double imbalance,
+                                     double quantile = 0.95) const;
+
     // Get model statistics
     double getMeanSlippage() const;
     double getSlippageStdDev() const;
     double getSlippageQuantile(double quantile) const;
 
-    // Save/load model parameters
-    void saveModel(const std::string& filename);
-    void loadModel(const std::string& filename);
+    // Versioned, checksummed binary file holding the history window, the
+    // quantile mode and the fitted regression. Loading maps the file and
+    // rebuilds the estimators in linear time, so a restart is warm at once.
+    // Both return false on I/O or format errors; a failed load changes nothing.
+    bool saveModel(const std::string& filename) const;
+    bool loadModel(const std::string& filename);
+
+    // The same content as a section of a larger state file
+    void writeState(StateWriter& writer) const;
+    bool readState(StateReader& reader);
 
 private:
     class Impl;
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free single-producer/single-consumer queue. Slots are
+// preallocated and filled in place, so element types that own storage (e.g.
+// std::string) keep their capacity between uses and the steady state does not
+// allocate. Capacity is rounded up to a power of two.
+template <typename T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(size_t capacity)
+        : slots_(roundUpPowerOfTwo(capacity))
+        , mask_(slots_.size() - 1) {}
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // Producer: slot to fill, or nullptr if the ring is full. The slot is only
+    // visible to the consumer after commitPush().
+    T* beginPush() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cachedTail_ == slots_.size()) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head - cachedTail_ == slots_.size()) return nullptr;
+        }
+        return &slots_[head & mask_];
+    }
+
+    void commitPush() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer: oldest element, or nullptr if the ring is empty
+    T* front() {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cachedHead_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail == cachedHead_) return nullptr;
+        }
+        return &slots_[tail & mask_];
+    }
+
+    // Consumer: release the slot returned by front()
+    void pop() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Slot access for preallocation before the ring is shared between threads
+    T& slot(size_t index) { return slots_[index]; }
+
+    // Approximate when called concurrently with push/pop
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    static size_t roundUpPowerOfTwo(size_t value) {
+        size_t result = 2;
+        while (result < value) result <<= 1;
+        return result;
+    }
+
+    std::vector<T> slots_;
+    const size_t mask_;
+
+    // Producer and consumer indices live on separate cache lines, each next to
+    // the owning thread's cached copy of the other index
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t cachedTail_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t cachedHead_ = 0;
+};
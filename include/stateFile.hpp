@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "mappedFile.hpp"
+
+// Versioned, checksummed binary container for model and simulator state: a
+// fixed header followed by the payload. Every field is padded to 8 bytes so
+// arrays of doubles can be used in place from the mapping. Native byte order.
+struct StateFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t payloadSize;
+    uint64_t checksum;     // stateChecksum() of the payload
+};
+
+// Fast 64-bit checksum (four independent lanes, xxHash-style rounds)
+uint64_t stateChecksum(const unsigned char* data, size_t size);
+
+// Builds a payload in memory, then writes it out in one go
+class StateWriter {
+public:
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "StateWriter::write needs a trivially copyable type");
+        append(&value, sizeof(T));
+    }
+
+    void writeString(const std::string& value);
+    void writeArray(const double* values, size_t count) { append(values, count * sizeof(double)); }
+
+    // Write to a temporary file and rename it over `path`, so a crash never
+    // leaves a half-written state behind
+    bool save(const std::string& path, const char (&magic)[9], uint32_t version) const;
+
+private:
+    std::vector<unsigned char> payload_;
+
+    void append(const void* data, size_t size);
+};
+
+// Reads a payload straight out of a read-only mapping of the file
+class StateReader {
+public:
+    // Map the file and check magic, version and checksum
+    bool open(const std::string& path, const char (&magic)[9], uint32_t version);
+
+    template <typename T>
+    bool read(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "StateReader::read needs a trivially copyable type");
+        const unsigned char* data = take(sizeof(T));
+        if (!data) return false;
+        std::memcpy(&value, data, sizeof(T));
+        return true;
+    }
+
+    bool readString(std::string& value);
+
+    // Pointer into the mapping, valid while the reader lives; nullptr if truncated
+    const double* readArray(size_t count);
+
+private:
+    MappedFile file_;
+    size_t offset_ = 0;
+
+    const unsigned char* take(size_t size);
+};
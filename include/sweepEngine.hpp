@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "orderbook.hpp"
+
+// Outcome of taking `requestedQuantity` from one side of the book with a market order
+struct SweepResult {
+    double requestedQuantity = 0.0;
+    double filledQuantity = 0.0;
+    double residualQuantity = 0.0;   // Left over once the captured levels run out
+    double notional = 0.0;           // Sum of price * quantity taken
+    double vwap = 0.0;               // Average fill price (0 if nothing filled)
+    double worstPrice = 0.0;         // Price of the deepest level touched
+    double cost = 0.0;               // Paid beyond the reference price, in quote currency
+    size_t levelsConsumed = 0;       // The last one possibly only partially
+
+    // Per-level attribution, best first; the first levelsConsumed entries are set
+    std::array<double, BookView::kMaxDepth> levelQuantities;
+    std::array<double, BookView::kMaxDepth> levelCosts;
+};
+
+// Walks one side of a BookView for market orders of any size. load() builds
+// prefix sums of quantity and notional over the contiguous level arrays once,
+// after which each size is a binary search plus one partial level, so many
+// candidate sizes can be priced per tick against the same snapshot.
+class SweepEngine {
+public:
+    // Prepare a side (asks for a buy, bids for a sell). Costs are measured
+    // against referencePrice, normally the mid.
+    void load(const BookView::Side& side, double referencePrice);
+
+    // Full sweep with per-level attribution
+    SweepResult sweep(double quantity) const;
+
+    // Batched form for candidate sizes: VWAP (NaN if nothing fills), cost and
+    // residual per size. Any output pointer may be null.
+    void sweepMany(const double* quantities, size_t count,
+                   double* vwaps, double* costs, double* residuals) const;
+
+    size_t depth() const { return depth_; }
+    double totalQuantity() const { return depth_ == 0 ? 0.0 : cumulativeQuantities_[depth_ - 1]; }
+
+private:
+    size_t depth_ = 0;
+    double referencePrice_ = 0.0;
+    std::array<double, BookView::kMaxDepth> prices_;
+    std::array<double, BookView::kMaxDepth> quantities_;
+    std::array<double, BookView::kMaxDepth> cumulativeQuantities_;   // Levels [0, i]
+    std::array<double, BookView::kMaxDepth> cumulativeNotionals_;    // Levels [0, i]
+
+    // First level whose cumulative quantity reaches quantity (depth_ if none)
+    size_t lastLevel(double quantity) const;
+    // Quantity and notional taken by a sweep of `quantity`, and levels touched
+    void fill(double quantity, double& filled, double& notional, size_t& levels) const;
+};
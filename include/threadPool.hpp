@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops. parallelFor hands out
+// indices from a shared counter, so uneven items balance themselves, and the
+// calling thread works too instead of blocking idle.
+class ThreadPool {
+public:
+    // 0 picks std::thread::hardware_concurrency()
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Threads taking part in parallelFor, counting the caller
+    size_t concurrency() const { return workers_.size() + 1; }
+
+    // Run fn(i) for every i in [0, count) and return once all calls finished.
+    // The first exception thrown by fn is rethrown here.
+    template <typename Fn>
+    void parallelFor(size_t count, Fn&& fn) {
+        std::atomic<size_t> next{0};
+        std::function<void()> body = [&]() {
+            for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+                 i = next.fetch_add(1, std::memory_order_relaxed)) {
+                fn(i);
+            }
+        };
+        run(body, count);
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable available_;
+    bool stopping_ = false;
+
+    void workerLoop();
+    // Run body on up to `count` threads (caller included) and wait for all of them
+    void run(const std::function<void()>& body, size_t count);
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+// Allocation-free UTC timestamp parser for exchange messages. Accepts
+// ISO8601 "YYYY-MM-DDTHH:MM:SS[.fffffffff]Z" and epoch-millisecond strings
+// ("1597026383085", as in OKX "ts"). Consecutive messages share a date, so
+// the date-to-days conversion is cached.
+class TimestampParser {
+public:
+    using Timestamp = std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>;
+
+    TimestampParser();
+
+    // Returns false (leaving result untouched) if the text is not a supported timestamp
+    bool parse(std::string_view text, Timestamp& result);
+
+private:
+    char cachedDate_[10];   // "YYYY-MM-DD" of the last ISO timestamp
+    int64_t cachedDays_;    // Days since the Unix epoch for cachedDate_
+
+    bool parseIso8601(std::string_view text, Timestamp& result);
+    static bool parseEpochMillis(std::string_view text, Timestamp& result);
+};
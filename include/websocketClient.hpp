@@ -10,6 +10,10 @@
 #include <string>
 #include <memory>
 #include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "spscRingBuffer.hpp"
 
 namespace beast = boost::beast;
 namespace websocket = beast::websocket;
@@ -21,6 +25,15 @@ class WebSocketClient {
 public:
     using MessageHandler = std::function<void(const std::string&)>;
     using ConnectionHandler = std::function<void()>;
+    using DrainHandler = std::function<void()>;
+
+    struct PipelineStats {
+        size_t capacity = 0;
+        size_t queueDepth = 0;        // Frames waiting for the compute thread
+        size_t highWatermark = 0;     // Deepest the queue has been
+        uint64_t enqueued = 0;        // Frames handed over by the I/O thread
+        uint64_t producerStalls = 0;  // Times the I/O thread found the queue full
+    };
 
     WebSocketClient();
     ~WebSocketClient();
@@ -33,6 +46,22 @@ public:
     
     // Set connection handler callback
     void setConnectionHandler(ConnectionHandler handler);
+
+    // Called on the handler thread between frames: after every frame in inline
+    // mode; in pipelined mode when the queue empties, and otherwise at least
+    // every maxFrames frames or maxDelay, so a queue that never empties under
+    // sustained load still gets drained
+    void setDrainHandler(DrainHandler handler,
+                         size_t maxFrames = 64,
+                         std::chrono::microseconds maxDelay = std::chrono::microseconds(1000));
+    
+    // Run the message handler on a dedicated compute thread. The I/O thread
+    // only copies frames into a preallocated lock-free SPSC ring of the given
+    // capacity. Must be called before connect().
+    void enablePipeline(size_t capacity = 1024, size_t reserveBytes = 64 * 1024);
+
+    // Queue counters (all zero when the pipeline is disabled)
+    PipelineStats getPipelineStats() const;
     
     // Close the connection
     void close();
@@ -44,10 +73,24 @@ private:
     std::thread io_thread_;
     MessageHandler messageHandler_;
     ConnectionHandler connectionHandler_;
-    bool isConnected_;
-    bool shouldStop_;
+    DrainHandler drainHandler_;
+    size_t drainMaxFrames_ = 64;
+    std::chrono::microseconds drainMaxDelay_{1000};
+    // Written by close() on the caller's thread while the I/O thread reads them
+    std::atomic<bool> isConnected_{false};
+    std::atomic<bool> shouldStop_{false};
+
+    // Pipelined mode
+    std::unique_ptr<SpscRingBuffer<std::string>> ring_;
+    std::thread compute_thread_;
+    std::atomic<bool> computeStop_{false};
+    std::atomic<size_t> highWatermark_{0};
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<uint64_t> producerStalls_{0};
 
     void run();
     void readLoop();
+    void computeLoop();
+    bool enqueue(const beast::flat_buffer& buffer);
     void handleError(const beast::error_code& ec, const char* what);
 };
@@ -0,0 +1,321 @@
+#include "bookMessageParser.hpp"
+#include "timestampParser.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// SAX handler for {"timestamp"|"ts": ..., "action": ..., "asks": [[px, qty, ...]], "bids": [...]}
+// and for trade objects {"sz": ..., "ts": ...}. Keys are matched at any object
+// depth so wrapped payloads are accepted too.
+class BookMessageParser::Impl {
+public:
+    std::vector<TickLevel> asks_;
+    std::vector<TickLevel> bids_;
+    std::string timestamp_;
+    bool isDelta_ = false;
+    bool hasLevels_ = false;   // An asks or bids array was present
+
+    // Trades in the frame: quantity and exchange time in seconds
+    struct Trade {
+        double quantity;
+        double timeStamp;
+    };
+    std::vector<Trade> trades_;
+    uint64_t droppedTrades_ = 0;   // Trades in the frame without a time of their own
+
+    // Conflation state: the latest snapshot (if any) plus every delta after it
+    struct StagedDelta {
+        int64_t tick;
+        double quantity;
+        uint64_t sequence;   // Arrival order, so the latest value per level wins
+    };
+
+    bool stagedSnapshot_ = false;
+    std::vector<TickLevel> stagedAsks_;
+    std::vector<TickLevel> stagedBids_;
+    std::vector<StagedDelta> stagedAskDeltas_;
+    std::vector<StagedDelta> stagedBidDeltas_;
+    std::string stagedTimestamp_;
+    uint64_t stagedMessages_ = 0;
+    uint64_t deltaSequence_ = 0;
+
+    explicit Impl(const DecimalParser& priceParser) : priceParser_(priceParser) {}
+
+    // Fold the frame just parsed into the staged state
+    void stage() {
+        if (!isDelta_) {
+            // A snapshot replaces the whole book, so anything staged before it is moot
+            stagedSnapshot_ = true;
+            stagedAsks_.swap(asks_);
+            stagedBids_.swap(bids_);
+            stagedAskDeltas_.clear();
+            stagedBidDeltas_.clear();
+        } else {
+            for (const auto& level : asks_) stagedAskDeltas_.push_back({level.tick, level.quantity, deltaSequence_++});
+            for (const auto& level : bids_) stagedBidDeltas_.push_back({level.tick, level.quantity, deltaSequence_++});
+        }
+        stagedTimestamp_.swap(timestamp_);
+        ++stagedMessages_;
+    }
+
+    // Collapse staged deltas into one entry per level holding its latest quantity
+    static void mergeDeltas(std::vector<StagedDelta>& deltas, std::vector<TickLevel>& merged) {
+        merged.clear();
+        std::sort(deltas.begin(), deltas.end(), [](const StagedDelta& a, const StagedDelta& b) {
+            return a.tick != b.tick ? a.tick < b.tick : a.sequence < b.sequence;
+        });
+        for (size_t i = 0; i < deltas.size(); ++i) {
+            if (i + 1 < deltas.size() && deltas[i + 1].tick == deltas[i].tick) continue;
+            merged.emplace_back(deltas[i].tick, deltas[i].quantity);
+        }
+        deltas.clear();
+    }
+
+    void clearStaged() {
+        stagedSnapshot_ = false;
+        stagedAsks_.clear();
+        stagedBids_.clear();
+        stagedAskDeltas_.clear();
+        stagedBidDeltas_.clear();
+        stagedMessages_ = 0;
+    }
+
+    void reset() {
+        asks_.clear();
+        bids_.clear();
+        timestamp_.clear();
+        isDelta_ = false;
+        hasLevels_ = false;
+        trades_.clear();
+        droppedTrades_ = 0;
+        objectDepth_ = tradeDepth_ = timestampDepth_ = 0;
+        pendingKey_ = Key::None;
+        side_ = nullptr;
+        sideDepth_ = 0;
+        field_ = 0;
+    }
+
+    // nlohmann SAX interface
+    bool null() { return value(); }
+    bool boolean(bool) { return value(); }
+    bool number_integer(json::number_integer_t val) { return number(static_cast<double>(val)); }
+    bool number_unsigned(json::number_unsigned_t val) { return number(static_cast<double>(val)); }
+    bool number_float(json::number_float_t val, const json::string_t&) { return number(val); }
+    bool binary(json::binary_t&) { return value(); }
+
+    bool string(json::string_t& val) {
+        if (side_ && sideDepth_ == 2) {
+            return stringField(val);
+        }
+        if (pendingKey_ == Key::Timestamp) {
+            timestamp_.assign(val);
+            objectTimestamp_.assign(val);
+            timestampDepth_ = objectDepth_;
+        } else if (pendingKey_ == Key::Action) {
+            isDelta_ = (val == "update");
+        } else if (pendingKey_ == Key::TradeSize) {
+            if (DecimalParser::parseDouble(val, tradeSize_) != DecimalParser::Status::Ok) return false;
+            tradeDepth_ = objectDepth_;
+        }
+        return value();
+    }
+
+    bool key(json::string_t& val) {
+        if (val == "asks") pendingKey_ = Key::Asks;
+        else if (val == "bids") pendingKey_ = Key::Bids;
+        else if (val == "timestamp" || val == "ts") pendingKey_ = Key::Timestamp;
+        else if (val == "action") pendingKey_ = Key::Action;
+        else if (val == "sz") pendingKey_ = Key::TradeSize;
+        else pendingKey_ = Key::None;
+        return true;
+    }
+
+    bool start_object(std::size_t) {
+        pendingKey_ = Key::None;
+        ++objectDepth_;
+        return !side_;  // Levels never contain objects
+    }
+
+    // A trade object is complete once it closes. Only its own "ts" counts: the
+    // frame's or a previous trade's time would file the volume under the
+    // wrong bucket, so a trade without one is dropped
+    bool end_object() {
+        const int depth = objectDepth_--;
+        if (tradeDepth_ == depth) {
+            tradeDepth_ = 0;
+            TimestampParser::Timestamp time;
+            if (timestampDepth_ == depth && timestampParser_.parse(objectTimestamp_, time)) {
+                trades_.push_back({tradeSize_, std::chrono::duration<double>(time.time_since_epoch()).count()});
+            } else {
+                ++droppedTrades_;
+            }
+        }
+        if (timestampDepth_ == depth) timestampDepth_ = 0;
+        return true;
+    }
+
+    bool start_array(std::size_t) {
+        if (side_) {
+            if (++sideDepth_ > 2) return false;
+            field_ = 0;
+            tick_ = 0;
+            quantity_ = 0.0;
+        } else if (pendingKey_ == Key::Asks || pendingKey_ == Key::Bids) {
+            side_ = (pendingKey_ == Key::Asks) ? &asks_ : &bids_;
+            sideDepth_ = 1;
+            hasLevels_ = true;
+        }
+        pendingKey_ = Key::None;
+        return true;
+    }
+
+    bool end_array() {
+        if (!side_) return true;
+        if (sideDepth_ == 2) {
+            if (field_ < 2) return false;  // Level without price and quantity
+            side_->emplace_back(tick_, quantity_);
+        } else {
+            side_ = nullptr;
+        }
+        --sideDepth_;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) {
+        return false;
+    }
+
+private:
+    enum class Key { None, Asks, Bids, Timestamp, Action, TradeSize };
+
+    Key pendingKey_ = Key::None;
+    const DecimalParser& priceParser_;
+    TimestampParser timestampParser_;
+    double tradeSize_ = 0.0;
+    std::string objectTimestamp_;              // Latest "ts", owned by the object at timestampDepth_
+    int objectDepth_ = 0;
+    int tradeDepth_ = 0;                       // Depth of the open object carrying "sz" (0 = none)
+    int timestampDepth_ = 0;                   // Depth of the open object carrying "ts" (0 = none)
+    std::vector<TickLevel>* side_ = nullptr;   // Side currently being filled
+    int sideDepth_ = 0;                        // 1 = side array, 2 = level array
+    int field_ = 0;                            // Position inside the level array
+    int64_t tick_ = 0;
+    double quantity_ = 0.0;
+
+    bool value() {
+        pendingKey_ = Key::None;
+        return !side_ || sideDepth_ == 2;
+    }
+
+    bool number(double val) {
+        if (side_ && sideDepth_ == 2) {
+            return field(val);
+        }
+        if (pendingKey_ == Key::TradeSize) {
+            tradeSize_ = val;
+            tradeDepth_ = objectDepth_;
+        }
+        return value();
+    }
+
+    // OKX levels carry extra fields (liquidated orders, order count) after price and size
+    bool field(double val) {
+        if (field_ == 0) tick_ = std::llround(val / priceParser_.getIncrement());
+        else if (field_ == 1) quantity_ = val;
+        ++field_;
+        return true;
+    }
+
+    bool stringField(const std::string& val) {
+        DecimalParser::Status status = DecimalParser::Status::Ok;
+        if (field_ == 0) status = priceParser_.parseUnits(val, tick_);
+        else if (field_ == 1) status = DecimalParser::parseDouble(val, quantity_);
+        ++field_;
+        return status == DecimalParser::Status::Ok;
+    }
+};
+
+BookMessageParser::BookMessageParser(OrderBook& orderbook)
+    : pImpl(std::make_unique<Impl>(orderbook.getPriceParser()))
+    , orderbook_(orderbook) {}
+
+BookMessageParser::~BookMessageParser() = default;
+
+void BookMessageParser::setConflation(bool enabled) {
+    if (conflate_ && !enabled) {
+        flush();
+    }
+    conflate_ = enabled;
+}
+
+bool BookMessageParser::process(const std::string& frame) {
+    auto start = std::chrono::steady_clock::now();
+
+    pImpl->reset();
+    if (!json::sax_parse(frame, pImpl.get())) {
+        ++stats_.errors;
+        return false;
+    }
+
+    // Subscribe acks, error events and pongs are valid JSON without levels;
+    // applied as a snapshot they would empty the book
+    if (!pImpl->hasLevels_) {
+        stats_.droppedTrades += pImpl->droppedTrades_;
+        if (pImpl->trades_.empty() || !tradeHandler_) {
+            ++stats_.ignored;
+            return false;
+        }
+        for (const auto& trade : pImpl->trades_) tradeHandler_(trade.quantity, trade.timeStamp);
+        stats_.trades += pImpl->trades_.size();
+        return false;
+    }
+
+    auto parsedAt = std::chrono::steady_clock::now();
+    stats_.lastParseNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(parsedAt - start).count();
+    stats_.totalParseNanos += stats_.lastParseNanos;
+    ++stats_.messages;
+
+    if (conflate_) {
+        pImpl->stage();
+        return true;
+    }
+
+    if (pImpl->isDelta_) {
+        orderbook_.applyDelta(pImpl->timestamp_, pImpl->asks_, pImpl->bids_);
+    } else {
+        orderbook_.update(pImpl->timestamp_, pImpl->asks_, pImpl->bids_);
+    }
+    recordApply(parsedAt);
+    return true;
+}
+
+bool BookMessageParser::flush() {
+    if (pImpl->stagedMessages_ == 0) return false;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Apply the latest snapshot, then the merged deltas that followed it;
+    // the per-message scratch vectors hold the merged levels
+    if (pImpl->stagedSnapshot_) {
+        orderbook_.update(pImpl->stagedTimestamp_, pImpl->stagedAsks_, pImpl->stagedBids_);
+    }
+    if (!pImpl->stagedAskDeltas_.empty() || !pImpl->stagedBidDeltas_.empty()) {
+        Impl::mergeDeltas(pImpl->stagedAskDeltas_, pImpl->asks_);
+        Impl::mergeDeltas(pImpl->stagedBidDeltas_, pImpl->bids_);
+        orderbook_.applyDelta(pImpl->stagedTimestamp_, pImpl->asks_, pImpl->bids_);
+    }
+
+    stats_.conflatedMessages += pImpl->stagedMessages_ - 1;
+    pImpl->clearStaged();
+    recordApply(start);
+    return true;
+}
+
+void BookMessageParser::recordApply(std::chrono::steady_clock::time_point start) {
+    auto appliedAt = std::chrono::steady_clock::now();
+    stats_.lastApplyNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(appliedAt - start).count();
+    stats_.totalApplyNanos += stats_.lastApplyNanos;
+}
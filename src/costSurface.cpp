@@ -0,0 +1,195 @@
+#include "costSurface.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace {
+
+// n log-spaced values from low to high
+std::vector<double> logSpaced(double low, double high, size_t n) {
+    std::vector<double> values(n);
+    double step = std::log(high / low) / static_cast<double>(n - 1);
+    for (size_t i = 0; i < n; ++i) values[i] = low * std::exp(step * static_cast<double>(i));
+    values[n - 1] = high;
+    return values;
+}
+
+// Index of the lower grid point and the fraction towards the next one
+void locate(double logValue, double logMin, double logStep, size_t count, size_t& index, double& fraction) {
+    double position = (logValue - logMin) / logStep;
+    if (std::isnan(position)) position = 0.0;
+    position = std::min(std::max(position, 0.0), static_cast<double>(count - 1));
+    index = std::min(static_cast<size_t>(position), count - 2);
+    fraction = position - static_cast<double>(index);
+}
+
+// Log cost of a cell, NaN when the cost has no log
+double logCost(double cost) {
+    return cost > 0.0 ? std::log(cost) : std::numeric_limits<double>::quiet_NaN();
+}
+
+// Weighted blend of n corners: in log cost when all of them have one (the
+// costs are sums of power laws, close to linear on log-log axes), otherwise
+// linearly in cost so that a zero corner pulls towards 0, not towards a floor
+template <size_t n>
+double blend(const std::array<double, n>& costs, const std::array<double, n>& logCosts,
+             const std::array<double, n>& weights) {
+    double logSum = 0.0, sum = 0.0;
+    for (size_t k = 0; k < n; ++k) {
+        logSum += weights[k] * logCosts[k];
+        sum += weights[k] * costs[k];
+    }
+    return std::isnan(logSum) ? sum : std::exp(logSum);
+}
+
+} // namespace
+
+CostSurface::CostSurface() {
+    for (auto* cells : {&rowCosts_, &rowLogCosts_}) {
+        for (auto& cell : *cells) cell.store(0.0, std::memory_order_relaxed);
+    }
+    for (auto* cells : {&gridCosts_, &gridLogCosts_}) {
+        for (auto& cell : *cells) cell.store(0.0, std::memory_order_relaxed);
+    }
+    configure(Config{});
+}
+
+void CostSurface::configure(const Config& config) {
+    config_ = config;
+    config_.sizeCount = std::clamp<size_t>(config_.sizeCount, 2, kMaxSizes);
+    config_.horizonCount = std::clamp<size_t>(config_.horizonCount, 2, kMaxHorizons);
+    config_.minSize = std::max(config_.minSize, 1e-12);
+    config_.maxSize = std::max(config_.maxSize, config_.minSize * 2.0);
+    config_.minHorizon = std::max(config_.minHorizon, 1e-6);
+    config_.maxHorizon = std::max(config_.maxHorizon, config_.minHorizon * 2.0);
+    config_.refreshThreshold = std::max(config_.refreshThreshold, 0.0);
+
+    sizes_ = logSpaced(config_.minSize, config_.maxSize, config_.sizeCount);
+    horizons_ = logSpaced(config_.minHorizon, config_.maxHorizon, config_.horizonCount);
+    published_.fill(false);
+
+    beginWrite();
+    rowValid_.store(false, std::memory_order_relaxed);
+    gridValid_.store(false, std::memory_order_relaxed);
+    sizeCount_.store(config_.sizeCount, std::memory_order_relaxed);
+    horizonCount_.store(config_.horizonCount, std::memory_order_relaxed);
+    logMinSize_.store(std::log(config_.minSize), std::memory_order_relaxed);
+    logSizeStep_.store(std::log(config_.maxSize / config_.minSize) / static_cast<double>(config_.sizeCount - 1),
+                       std::memory_order_relaxed);
+    logMinHorizon_.store(std::log(config_.minHorizon), std::memory_order_relaxed);
+    logHorizonStep_.store(std::log(config_.maxHorizon / config_.minHorizon) / static_cast<double>(config_.horizonCount - 1),
+                          std::memory_order_relaxed);
+    endWrite();
+
+    writerStats_.sizeCount = config_.sizeCount;
+    writerStats_.horizonCount = config_.horizonCount;
+    stats_.store(writerStats_);
+}
+
+bool CostSurface::needsRefresh(Part part, const Inputs& inputs, double timeStamp) {
+    const size_t p = static_cast<size_t>(part);
+    if (!published_[p]) return true;
+
+    double drift = 0.0;
+    for (size_t i = 0; i < kInputCount; ++i) {
+        double scale = std::max(std::abs(inputs_[p][i]), std::abs(inputs[i]));
+        if (scale > 0.0) drift = std::max(drift, std::abs(inputs[i] - inputs_[p][i]) / scale);
+    }
+    drifts_[p] = drift;
+    ages_[p] = timeStamp - refreshTimes_[p];
+
+    bool stale = drift > config_.refreshThreshold || ages_[p] >= config_.maxAge;
+    if (!stale) ++writerStats_.skippedRefreshes;
+    storeStats();
+    return stale;
+}
+
+void CostSurface::publish(Part part, const double* costs, const Inputs& inputs, double timeStamp,
+                          double elapsedMicros) {
+    const size_t p = static_cast<size_t>(part);
+    beginWrite();
+    if (part == Part::Row) {
+        for (size_t i = 0; i < config_.sizeCount; ++i) {
+            rowCosts_[i].store(costs[i], std::memory_order_relaxed);
+            rowLogCosts_[i].store(logCost(costs[i]), std::memory_order_relaxed);
+        }
+        rowValid_.store(true, std::memory_order_relaxed);
+    } else {
+        for (size_t i = 0; i < config_.sizeCount * config_.horizonCount; ++i) {
+            gridCosts_[i].store(costs[i], std::memory_order_relaxed);
+            gridLogCosts_[i].store(logCost(costs[i]), std::memory_order_relaxed);
+        }
+        gridValid_.store(true, std::memory_order_relaxed);
+    }
+    endWrite();
+
+    inputs_[p] = inputs;
+    published_[p] = true;
+    refreshTimes_[p] = timeStamp;
+    ages_[p] = 0.0;
+    drifts_[p] = 0.0;
+    ++(part == Part::Row ? writerStats_.rowRefreshes : writerStats_.gridRefreshes);
+    writerStats_.lastRefreshTime = timeStamp;
+    writerStats_.lastRefreshMicros = elapsedMicros;
+    storeStats();
+}
+
+void CostSurface::storeStats() {
+    writerStats_.age = std::max(ages_[0], ages_[1]);
+    writerStats_.inputDrift = std::max(drifts_[0], drifts_[1]);
+    stats_.store(writerStats_);
+}
+
+double CostSurface::lookup(double size, double horizon) const {
+    const double logSize = std::log(std::max(std::abs(size), std::numeric_limits<double>::min()));
+    const double logHorizon = std::log(std::max(horizon, std::numeric_limits<double>::min()));
+
+    unsigned attempts = 0;
+    while (true) {
+        const uint64_t before = sequence_.load(std::memory_order_acquire);
+        if ((before & 1) == 0) {
+            size_t sizeCount = sizeCount_.load(std::memory_order_relaxed);
+            size_t horizonCount = horizonCount_.load(std::memory_order_relaxed);
+
+            size_t i, j;
+            double u, v;
+            locate(logSize, logMinSize_.load(std::memory_order_relaxed), logSizeStep_.load(std::memory_order_relaxed),
+                   sizeCount, i, u);
+            locate(logHorizon, logMinHorizon_.load(std::memory_order_relaxed),
+                   logHorizonStep_.load(std::memory_order_relaxed), horizonCount, j, v);
+
+            const std::array<double, 2> rowCosts = {rowCosts_[i].load(std::memory_order_relaxed),
+                                                     rowCosts_[i + 1].load(std::memory_order_relaxed)};
+            const std::array<double, 2> rowLogCosts = {rowLogCosts_[i].load(std::memory_order_relaxed),
+                                                        rowLogCosts_[i + 1].load(std::memory_order_relaxed)};
+            const size_t base = j * sizeCount + i;
+            const std::array<size_t, 4> corners = {base, base + 1, base + sizeCount, base + sizeCount + 1};
+            std::array<double, 4> gridCosts, gridLogCosts;
+            for (size_t k = 0; k < corners.size(); ++k) {
+                gridCosts[k] = gridCosts_[corners[k]].load(std::memory_order_relaxed);
+                gridLogCosts[k] = gridLogCosts_[corners[k]].load(std::memory_order_relaxed);
+            }
+            bool valid = rowValid_.load(std::memory_order_relaxed) && gridValid_.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                if (!valid) return std::numeric_limits<double>::quiet_NaN();
+                const std::array<double, 2> rowWeights = {1.0 - u, u};
+                const std::array<double, 4> gridWeights = {(1.0 - v) * (1.0 - u), (1.0 - v) * u, v * (1.0 - u), v * u};
+                return blend(rowCosts, rowLogCosts, rowWeights) + blend(gridCosts, gridLogCosts, gridWeights);
+            }
+        }
+        if (++attempts % 64 == 0) std::this_thread::yield();  // Writer was preempted mid-publish
+    }
+}
+
+void CostSurface::beginWrite() {
+    const uint64_t seq = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(seq + 1, std::memory_order_relaxed);  // Odd: write in progress
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void CostSurface::endWrite() {
+    sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
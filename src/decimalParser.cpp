@@ -0,0 +1,116 @@
+#include "decimalParser.hpp"
+#include <charconv>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+namespace {
+constexpr int kMaxDecimals = 12;
+constexpr int kMaxMantissaDigits = 18;  // 10^18 < INT64_MAX
+constexpr int kMaxExtraDigits = 6;      // Fractional digits kept past the increment for rounding
+
+constexpr int64_t kPow10[] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL,
+    1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+    100000000000000LL, 1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+    1000000000000000000LL
+};
+}
+
+DecimalParser::DecimalParser(double increment)
+    : increment_(increment)
+    , decimals_(0)
+    , incrementScaled_(1) {
+    // Find the shortest decimal representation of the increment, e.g. 0.1 -> 1 x 10^-1
+    for (int d = 0; d <= kMaxDecimals; ++d) {
+        double scaled = increment * static_cast<double>(kPow10[d]);
+        double rounded = std::round(scaled);
+        if (rounded >= 1.0 && std::abs(scaled - rounded) <= 1e-9 * rounded) {
+            decimals_ = d;
+            incrementScaled_ = static_cast<int64_t>(rounded);
+            return;
+        }
+    }
+    decimals_ = kMaxDecimals;
+    incrementScaled_ = std::max<int64_t>(1, std::llround(increment * static_cast<double>(kPow10[kMaxDecimals])));
+}
+
+DecimalParser::Status DecimalParser::parseDouble(std::string_view text, double& value) {
+    if (text.empty()) return Status::Empty;
+
+    const char* first = text.data();
+    const char* last = text.data() + text.size();
+    if (*first == '+') ++first;  // from_chars rejects a leading plus
+
+    auto [ptr, ec] = std::from_chars(first, last, value);
+    if (ec == std::errc::result_out_of_range) return Status::OutOfRange;
+    if (ec != std::errc() || ptr != last) return Status::Invalid;
+    // from_chars also takes "nan" and "inf", which slip past `<= 0` guards downstream
+    if (!std::isfinite(value)) return Status::Invalid;
+    return Status::Ok;
+}
+
+DecimalParser::Status DecimalParser::parseUnits(std::string_view text, int64_t& units) const {
+    if (text.empty()) return Status::Empty;
+
+    bool negative = false;
+    if (text.front() == '-' || text.front() == '+') {
+        negative = (text.front() == '-');
+        text.remove_prefix(1);
+    }
+
+    // Trailing zeros after the point carry no value but would use up precision
+    size_t point = text.find('.');
+    if (point != std::string_view::npos) {
+        while (text.size() > point + 1 && text.back() == '0') text.remove_suffix(1);
+    }
+
+    // Accumulate the significant digits into one integer mantissa scaled by 10^-fractionDigits
+    int64_t mantissa = 0;
+    int mantissaDigits = 0;
+    int fractionDigits = 0;
+    bool seenDigit = false;
+    bool seenPoint = false;
+
+    for (char c : text) {
+        if (c == '.') {
+            if (seenPoint) return Status::Invalid;
+            seenPoint = true;
+            continue;
+        }
+        unsigned digit = static_cast<unsigned>(c - '0');
+        if (digit > 9) return Status::Invalid;
+        seenDigit = true;
+
+        if (seenPoint) {
+            // Digits this far below the increment cannot change the rounded result
+            if (fractionDigits == decimals_ + kMaxExtraDigits) continue;
+            ++fractionDigits;
+        }
+        if (mantissa == 0 && digit == 0) continue;  // Leading zeros
+        if (++mantissaDigits > kMaxMantissaDigits) return Status::OutOfRange;
+        mantissa = mantissa * 10 + digit;
+    }
+    if (!seenDigit) return Status::Invalid;
+
+    // units = mantissa * 10^-fractionDigits / (incrementScaled_ * 10^-decimals_), rounded
+    int64_t result = 0;
+    if (fractionDigits <= decimals_) {
+        int64_t scale = kPow10[decimals_ - fractionDigits];
+        if (mantissa > std::numeric_limits<int64_t>::max() / scale) return Status::OutOfRange;
+        int64_t scaled = mantissa * scale;
+        result = scaled / incrementScaled_;
+        int64_t remainder = scaled % incrementScaled_;
+        if (remainder >= incrementScaled_ - remainder) ++result;
+    } else {
+        int64_t divisor = kPow10[fractionDigits - decimals_];
+        if (incrementScaled_ > std::numeric_limits<int64_t>::max() / divisor) return Status::OutOfRange;
+        divisor *= incrementScaled_;
+        result = mantissa / divisor;
+        int64_t remainder = mantissa % divisor;
+        if (remainder >= divisor - remainder) ++result;
+    }
+
+    units = negative ? -result : result;
+    return Status::Ok;
+}
@@ -0,0 +1,51 @@
+#include "efficientFrontier.hpp"
+#include "stateFile.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr char kFrontierMagic[9] = "QSFRONTR";
+constexpr uint32_t kFrontierVersion = 1;
+
+} // namespace
+
+EfficientFrontier::EfficientFrontier(const std::vector<double>& riskAversions, const std::vector<double>& horizons)
+    : riskAversionCount_(riskAversions.size())
+    , horizonCount_(horizons.size())
+    , data_(riskAversionCount_ + horizonCount_ + 3 * riskAversionCount_ * horizonCount_, 0.0) {
+    std::copy(riskAversions.begin(), riskAversions.end(), data_.begin());
+    std::copy(horizons.begin(), horizons.end(), data_.begin() + riskAversionCount_);
+}
+
+bool EfficientFrontier::save(const std::string& filename) const {
+    StateWriter writer;
+    writer.write(static_cast<uint64_t>(riskAversionCount_));
+    writer.write(static_cast<uint64_t>(horizonCount_));
+    writer.writeArray(data_.data(), data_.size());
+    return writer.save(filename, kFrontierMagic, kFrontierVersion);
+}
+
+bool EfficientFrontier::load(const std::string& filename) {
+    StateReader reader;
+    uint64_t riskAversionCount = 0, horizonCount = 0;
+    if (!reader.open(filename, kFrontierMagic, kFrontierVersion) ||
+        !reader.read(riskAversionCount) || !reader.read(horizonCount)) {
+        return false;
+    }
+    // Counts come from the file: reject any whose buffer size would wrap
+    const uint64_t limit = std::numeric_limits<size_t>::max();
+    if (riskAversionCount > limit / 3 || horizonCount > limit - riskAversionCount ||
+        (riskAversionCount != 0 &&
+         horizonCount > (limit - riskAversionCount - horizonCount) / (3 * riskAversionCount))) {
+        return false;
+    }
+    size_t size = riskAversionCount + horizonCount + 3 * riskAversionCount * horizonCount;
+    const double* values = reader.readArray(size);
+    if (!values) return false;
+
+    riskAversionCount_ = riskAversionCount;
+    horizonCount_ = horizonCount;
+    data_.assign(values, values + size);
+    return true;
+}
@@ -1,16 +1,18 @@
 #include "websocketClient.hpp"
 #include "orderbook.hpp"
 #include "simulator.hpp"
+#include "bookMessageParser.hpp"
 #include <iostream>
 #include <fstream>
 #include <map>
 #include <string>
 #include <thread>
 #include <chrono>
-#include <nlohmann/json.hpp>
+#include <cmath>
+#include <vector>
+#include <limits>
 #include <iomanip>
-
-using json = nlohmann::json;
+#include <sstream>
 
 // parse env
 std::map<std::string, std::string> load_env(const std::string& filepath = ".env") {
@@ -44,6 +46,16 @@ void printMetrics(const DetailedTradeMetrics& metrics) {
     std::cout << "Current Spread: " << metrics.currentSpread << "\n";
     std::cout << "Mid Price: " << metrics.midPrice << "\n";
     std::cout << "Order Book Imbalance: " << (metrics.orderBookImbalance * 100) << "%\n\n";
+    std::cout << "Book Sweep VWAP: " << metrics.sweepVwap << "\n";
+    std::cout << "Book Sweep Cost: " << metrics.sweepCost << "\n";
+    std::cout << "Book Sweep Levels: " << metrics.sweepLevelsConsumed << "\n";
+    std::cout << "Book Sweep Unfilled: " << metrics.sweepResidual << "\n";
+    std::cout << "Regression Slippage: " << metrics.regressionSlippage << "\n\n";
+    if (metrics.hasCostDistribution) {
+        std::cout << "Simulated Cost Mean: " << metrics.costMean << "\n";
+        std::cout << "Simulated Cost VaR (" << metrics.costConfidence * 100 << "%): " << metrics.costValueAtRisk << "\n";
+        std::cout << "Simulated Cost ES (" << metrics.costConfidence * 100 << "%): " << metrics.costExpectedShortfall << "\n\n";
+    }
     
 }
 
@@ -54,53 +66,183 @@ int main() {
     std::string exchange = env["EXCHANGE"];
     std::string symbol   = env["SYMBOL"];
     double initial_capital = std::stod(env["INITIAL_CAPITAL"]);
+    double tick_size = env.count("TICK_SIZE") ? std::stod(env["TICK_SIZE"]) : OrderBook::kDefaultTickSize;
 
-    OrderBook orderbook(exchange, symbol);
+    OrderBook orderbook(exchange, symbol, tick_size);
     Simulator simulator;
 
     simulator.initialize(exchange, symbol, initial_capital);
 
+    // PARAM_UPDATE_SECONDS sets how often streaming volatility/volume estimates reach the impact model
+    if (env.count("PARAM_UPDATE_SECONDS")) {
+        simulator.setParameterUpdateInterval(std::stod(env["PARAM_UPDATE_SECONDS"]));
+    }
+
+    // IMPACT_PARAMS=path loads impact factors written by calibrate_impact
+    std::string impact_params = env["IMPACT_PARAMS"];
+    if (!impact_params.empty()) {
+        if (simulator.loadImpactParameters(impact_params)) {
+            std::cout << "Loaded impact parameters from " << impact_params << std::endl;
+        } else {
+            std::cout << "Could not load impact parameters from " << impact_params << ", using defaults" << std::endl;
+        }
+    }
+
+    // MONTE_CARLO_PATHS=n simulates each order's cost distribution over n paths on all cores
+    if (env.count("MONTE_CARLO_PATHS")) {
+        MonteCarloEngine::Config monte_carlo;
+        monte_carlo.paths = std::stoul(env["MONTE_CARLO_PATHS"]);
+        if (env.count("MONTE_CARLO_SEED")) monte_carlo.seed = std::stoull(env["MONTE_CARLO_SEED"]);
+        simulator.enableMonteCarlo(monte_carlo);
+    }
+
+    // STATE_FILE=path warm-starts the portfolio and slippage model and saves them on exit
+    std::string state_file = env["STATE_FILE"];
+    if (!state_file.empty()) {
+        if (simulator.loadState(state_file)) {
+            std::cout << "Loaded simulator state from " << state_file << std::endl;
+        } else {
+            std::cout << "No usable simulator state in " << state_file << ", starting cold" << std::endl;
+        }
+    }
+
+    BookMessageParser parser(orderbook);
+
+    // Trades feed the daily volume estimate, whether they arrive on the book
+    // connection or on their own (TRADES_PATH, same host and port)
+    auto record_trade = [&simulator](double quantity, double timeStamp) {
+        simulator.recordTrade(quantity, timeStamp);
+    };
+    parser.setTradeHandler(record_trade);
+
+    // PIPELINE=1 moves parsing and metrics off the socket thread
+    bool pipelined = env["PIPELINE"] == "1";
+    if (pipelined) {
+        client.enablePipeline();
+    }
+
+    // CONFLATE=1 applies queued frames as one merged update. Inline, every
+    // frame is drained on its own, so it only makes a difference with PIPELINE=1
+    if (env["CONFLATE"] == "1") {
+        if (pipelined) {
+            parser.setConflation(true);
+        } else {
+            std::cout << "CONFLATE=1 has no effect without PIPELINE=1, ignoring" << std::endl;
+        }
+    }
+
+    WebSocketClient trades_client;
+    OrderBook trade_book(exchange, symbol, tick_size);
+    BookMessageParser trade_parser(trade_book);
+    trade_parser.setTradeHandler(record_trade);
+    trades_client.setMessageHandler([&trade_parser](const std::string& message) {
+        try {
+            trade_parser.process(message);
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing trade message: " << e.what() << std::endl;
+        }
+    });
+
+    // Cost curve priced on every tick: log-spaced sizes on both sides, as market orders over one minute
+    constexpr size_t kCurveSizes = 64;
+    std::vector<double> curve_sizes, curve_limits, curve_horizons;
+    std::vector<OrderSide> curve_sides;
+    for (OrderSide side : {OrderSide::Buy, OrderSide::Sell}) {
+        for (size_t i = 0; i < kCurveSizes; ++i) {
+            curve_sizes.push_back(1e-5 * std::pow(10.0, 6.0 * i / (kCurveSizes - 1)));   // 0.00001 to 10
+            curve_sides.push_back(side);
+            curve_limits.push_back(side == OrderSide::Buy ? std::numeric_limits<double>::infinity() : 0.0);
+            curve_horizons.push_back(60.0);
+        }
+    }
+    TradeMetricsBatch curve;
+
+    // Runs after the orderbook reflects new data
+    auto onBookUpdated = [&]() {
+        const auto& ingest = parser.getStats();
+        auto bestBid = orderbook.getBestBid();
+        auto bestAsk = orderbook.getBestAsk();
+        if (!bestBid || !bestAsk) {
+            std::cerr << "Orderbook has an empty side, skipping metrics" << std::endl;
+            return;
+        }
+        std::cout << "----- Orderbook Bests----- " << std::endl;
+        std::cout << "Best Bid: " << bestBid->price << std::endl;
+        std::cout << "Best Ask: " << bestAsk->price << std::endl;
+        std::cout << "Parse+Apply: " << (ingest.lastParseNanos + ingest.lastApplyNanos) / 1000.0 << " us" << std::endl;
+        std::cout << "Feed Latency: " << orderbook.getFeedLatency().count() / 1e6 << " ms" << std::endl;
+        if (pipelined) {
+            auto queue = client.getPipelineStats();
+            std::cout << "Queue Depth: " << queue.queueDepth << " (high " << queue.highWatermark << ")" << std::endl;
+        }
+        if (parser.isConflating()) {
+            std::cout << "Conflated Messages: " << ingest.conflatedMessages << std::endl;
+        }
+        std::cout << "-------------------------- " << std::endl;
+
+        simulator.updateMarketData(orderbook);
+        
+        // Example: Buy 0.1 BTC at market
+        auto metrics = simulator.calculateTradeMetrics(
+            0.0000096,                // Order size
+            0.0,               // Market order (no limit price)
+            "market",          // Order type
+            orderbook,         // Current orderbook
+            60.0              // 1-minute time horizon
+        );
+        printMetrics(metrics);
+
+        auto estimates = simulator.getMarketEstimates();
+        std::cout << "Volatility (EWMA / Parkinson / Garman-Klass): " << estimates.ewmaVolatility << " / "
+                  << estimates.parkinsonVolatility << " / " << estimates.garmanKlassVolatility << "\n";
+        std::cout << "Daily Volume Estimate: " << estimates.dailyVolume << " (0 until trades arrive)\n\n";
+
+        auto curve_start = std::chrono::steady_clock::now();
+        simulator.calculateTradeMetricsBatch(curve_sizes.data(), curve_sides.data(), curve_limits.data(),
+                                             curve_horizons.data(), curve_sizes.size(), orderbook, curve);
+        auto curve_time = std::chrono::steady_clock::now() - curve_start;
+        std::cout << "Cost Curve: " << curve.size() << " orders in "
+                  << std::chrono::duration<double, std::micro>(curve_time).count() << " us\n";
+        for (size_t i : {size_t(0), kCurveSizes / 2, kCurveSizes - 1}) {
+            std::cout << "  size " << curve_sizes[i] << ": buy " << curve.netCost[i]
+                      << " / sell " << curve.netCost[kCurveSizes + i] << "\n";
+        }
+
+        auto surface = simulator.getCostSurfaceStats();
+        std::cout << "Cost Surface: " << surface.sizeCount << "x" << surface.horizonCount
+                  << ", refreshes " << surface.rowRefreshes << " row / " << surface.gridRefreshes << " grid"
+                  << " (skipped " << surface.skippedRefreshes << ")"
+                  << ", age " << surface.age << " s, drift " << surface.inputDrift
+                  << ", last refresh " << surface.lastRefreshMicros << " us\n";
+        std::cout << "Cost of 1 over 5 min (surface): " << simulator.lookupExpectedCost(1.0, 300.0) << "\n\n";
+    };
+
     // Set up message handler
-    client.setMessageHandler([&orderbook, &simulator](const std::string& message) {
+    client.setMessageHandler([&parser, &onBookUpdated](const std::string& message) {
         try {
-            auto data = json::parse(message);
-            
-            // Extracting orderbook data
-            std::string timestamp = data["timestamp"];
-            auto asks = data["asks"].get<std::vector<std::vector<std::string>>>();
-            auto bids = data["bids"].get<std::vector<std::vector<std::string>>>();
-            std::vector<std::pair<std::string, std::string>> askLevels;
-            std::vector<std::pair<std::string, std::string>> bidLevels;
-            
-            for (const auto& ask : asks){
-                askLevels.emplace_back(ask[0], ask[1]);
+            // Parse the frame straight into the orderbook; frames without levels are skipped quietly
+            uint64_t errors = parser.getStats().errors;
+            if (!parser.process(message)) {
+                if (parser.getStats().errors != errors) {
+                    std::cerr << "Error processing message: malformed orderbook frame" << std::endl;
+                }
+                return;
             }
-            
-            for (const auto& bid : bids){
-                bidLevels.emplace_back(bid[0], bid[1]);
+            if (!parser.isConflating()) {
+                onBookUpdated();
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing message: " << e.what() << std::endl;
+        }
+    });
+
+    // With conflation, staged frames are applied when the queue empties, and
+    // every 64 frames or 1 ms while it does not
+    client.setDrainHandler([&parser, &onBookUpdated]() {
+        try {
+            if (parser.isConflating() && parser.flush()) {
+                onBookUpdated();
             }
-            
-            // Update the orderbook
-            orderbook.update(timestamp, askLevels, bidLevels);
-            auto bestBid = orderbook.getBestBid();
-            auto bestAsk = orderbook.getBestAsk();
-            std::cout << "----- Orderbook Bests----- " << std::endl;
-            std::cout << "Best Bid: " << bestBid->price << std::endl;
-            std::cout << "Best Ask: " << bestAsk->price << std::endl;
-            std::cout << "-------------------------- " << std::endl;
-
-            simulator.updateMarketData(orderbook);
-            
-            // Example: Buy 0.1 BTC at market
-            auto metrics = simulator.calculateTradeMetrics(
-                0.0000096,                // Order size
-                0.0,               // Market order (no limit price)
-                "market",          // Order type
-                orderbook,         // Current orderbook
-                60.0              // 1-minute time horizon
-            );
-            printMetrics(metrics);
-            
         } catch (const std::exception& e) {
             std::cerr << "Error processing message: " << e.what() << std::endl;
         }
@@ -119,11 +261,24 @@ int main() {
     std::cout << "Connecting to " << host << ":" << port << path << std::endl;
     client.connect(host, port, path);
 
+    // The trade connection only carries trades; its parser gets a book of its
+    // own so a stray book frame there cannot race the main book
+    std::string trades_path = env["TRADES_PATH"];
+    if (!trades_path.empty()) {
+        std::cout << "Connecting to " << host << ":" << port << trades_path << " for trades" << std::endl;
+        trades_client.connect(host, port, trades_path);
+    }
+
     // Keep the main thread alive for a while
     std::this_thread::sleep_for(std::chrono::seconds(30));
 
     // Clean up
     client.close();
+    trades_client.close();
+
+    if (!state_file.empty() && !simulator.saveState(state_file)) {
+        std::cerr << "Failed to save simulator state to " << state_file << std::endl;
+    }
 
     return 0;
 }
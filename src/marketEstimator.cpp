@@ -0,0 +1,157 @@
+#include "marketEstimator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+constexpr double kSecondsPerDay = 86400.0;
+const double kLog2 = std::log(2.0);
+
+} // namespace
+
+MarketEstimator::MarketEstimator()
+    : MarketEstimator(Config{}) {}
+
+MarketEstimator::MarketEstimator(const Config& config)
+    : config_(config) {
+    config_.barSeconds = std::max(config_.barSeconds, 1e-3);
+    config_.ewmaDecay = std::clamp(config_.ewmaDecay, 0.0, 1.0);
+    config_.rangeBars = std::max<size_t>(config_.rangeBars, 1);
+    config_.volumeBuckets = std::max<size_t>(config_.volumeBuckets, 1);
+    config_.volumeWindowSeconds = std::max(config_.volumeWindowSeconds, config_.barSeconds);
+    bucketSeconds_ = config_.volumeWindowSeconds / static_cast<double>(config_.volumeBuckets);
+    reset();
+}
+
+void MarketEstimator::reset() {
+    barOpen_ = false;
+    previousClose_ = 0.0;
+    completedBars_ = 0;
+    returnCount_ = 0;
+    ewmaVariance_ = 0.0;
+    parkinsonTerms_.assign(config_.rangeBars, 0.0);
+    garmanKlassTerms_.assign(config_.rangeBars, 0.0);
+    rangeHead_ = rangeCount_ = 0;
+    parkinsonSum_ = garmanKlassSum_ = 0.0;
+
+    volumeBuckets_.assign(config_.volumeBuckets, 0.0);
+    volumeSum_ = 0.0;
+    hasVolume_ = false;
+}
+
+void MarketEstimator::update(double midPrice, double timeStamp) {
+    if (midPrice > 0.0) {
+        int64_t bar = static_cast<int64_t>(std::floor(timeStamp / config_.barSeconds));
+        if (barOpen_ && bar > barIndex_) {
+            closeBar();
+            barOpen_ = false;
+        }
+        if (!barOpen_) {
+            barOpen_ = true;
+            barIndex_ = bar;
+            open_ = high_ = low_ = close_ = midPrice;
+        } else {
+            high_ = std::max(high_, midPrice);
+            low_ = std::min(low_, midPrice);
+            close_ = midPrice;
+        }
+    }
+    advanceVolumeWindow(timeStamp);
+}
+
+void MarketEstimator::closeBar() {
+    ++completedBars_;
+    if (previousClose_ > 0.0) {
+        // Bars without ticks in between: the return spans all of them
+        double r = std::log(close_ / previousClose_);
+        double variance = r * r / static_cast<double>(std::max<int64_t>(barIndex_ - previousCloseBar_, 1));
+        ewmaVariance_ = returnCount_ == 0
+            ? variance
+            : config_.ewmaDecay * ewmaVariance_ + (1.0 - config_.ewmaDecay) * variance;
+        ++returnCount_;
+    }
+    previousClose_ = close_;
+    previousCloseBar_ = barIndex_;
+
+    double highLow = std::log(high_ / low_);
+    double closeOpen = std::log(close_ / open_);
+    pushRangeTerms(highLow * highLow / (4.0 * kLog2),
+                   0.5 * highLow * highLow - (2.0 * kLog2 - 1.0) * closeOpen * closeOpen);
+}
+
+void MarketEstimator::pushRangeTerms(double parkinson, double garmanKlass) {
+    if (rangeCount_ == config_.rangeBars) {
+        parkinsonSum_ -= parkinsonTerms_[rangeHead_];
+        garmanKlassSum_ -= garmanKlassTerms_[rangeHead_];
+    } else {
+        ++rangeCount_;
+    }
+    parkinsonTerms_[rangeHead_] = parkinson;
+    garmanKlassTerms_[rangeHead_] = garmanKlass;
+    parkinsonSum_ += parkinson;
+    garmanKlassSum_ += garmanKlass;
+
+    // Resum once per lap so rounding from the subtractions cannot build up
+    if (++rangeHead_ == config_.rangeBars) {
+        rangeHead_ = 0;
+        parkinsonSum_ = std::accumulate(parkinsonTerms_.begin(), parkinsonTerms_.end(), 0.0);
+        garmanKlassSum_ = std::accumulate(garmanKlassTerms_.begin(), garmanKlassTerms_.end(), 0.0);
+    }
+}
+
+void MarketEstimator::addTrade(double quantity, double timeStamp) {
+    if (!(quantity > 0.0)) return;
+    if (!hasVolume_) {
+        hasVolume_ = true;
+        firstTimeStamp_ = lastTimeStamp_ = timeStamp;
+        bucketIndex_ = static_cast<int64_t>(std::floor(timeStamp / bucketSeconds_));
+    }
+    advanceVolumeWindow(timeStamp);
+    volumeBuckets_[static_cast<size_t>(bucketIndex_ % static_cast<int64_t>(volumeBuckets_.size()))] += quantity;
+    volumeSum_ += quantity;
+}
+
+// Move the window up to timeStamp, emptying the buckets that slid out of it
+void MarketEstimator::advanceVolumeWindow(double timeStamp) {
+    if (!hasVolume_) return;
+    lastTimeStamp_ = std::max(lastTimeStamp_, timeStamp);
+
+    int64_t bucket = static_cast<int64_t>(std::floor(timeStamp / bucketSeconds_));
+    if (bucket <= bucketIndex_) return;
+    const int64_t buckets = static_cast<int64_t>(volumeBuckets_.size());
+    int64_t steps = std::min(bucket - bucketIndex_, buckets);
+    bool wrapped = false;
+    for (int64_t s = 1; s <= steps; ++s) {
+        size_t slot = static_cast<size_t>((bucketIndex_ + s) % buckets);
+        volumeSum_ -= volumeBuckets_[slot];
+        volumeBuckets_[slot] = 0.0;
+        wrapped |= slot == 0;
+    }
+    if (wrapped) {
+        volumeSum_ = std::accumulate(volumeBuckets_.begin(), volumeBuckets_.end(), 0.0);
+    }
+    bucketIndex_ = bucket;
+}
+
+MarketEstimates MarketEstimator::estimates() const {
+    MarketEstimates result;
+    result.completedBars = completedBars_;
+
+    const double barsPerDay = kSecondsPerDay / config_.barSeconds;
+    if (returnCount_ > 0) {
+        result.ewmaVolatility = std::sqrt(ewmaVariance_ * barsPerDay);
+    }
+    if (rangeCount_ > 0) {
+        double count = static_cast<double>(rangeCount_);
+        result.parkinsonVolatility = std::sqrt(std::max(parkinsonSum_ / count, 0.0) * barsPerDay);
+        result.garmanKlassVolatility = std::sqrt(std::max(garmanKlassSum_ / count, 0.0) * barsPerDay);
+    }
+
+    // Scale to a day, extrapolating while the window is not yet full
+    if (hasVolume_) {
+        double covered = std::clamp(lastTimeStamp_ - firstTimeStamp_, bucketSeconds_, config_.volumeWindowSeconds);
+        result.dailyVolume = std::max(volumeSum_, 0.0) * kSecondsPerDay / covered;
+    }
+    return result;
+}
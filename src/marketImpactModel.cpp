@@ -1,11 +1,18 @@
 #include "marketImpactModel.hpp"
+#include "threadPool.hpp"
+#include "decimalParser.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 
-MarketImpactModel::MarketImpactModel()
-    : volatility_(0.0)
-    , dailyVolume_(0.0)
-    , permanentImpactFactor_(0.1)
-    , temporaryImpactFactor_(0.1) {}
+MarketImpactModel::MarketImpactModel() {
+    parameters_.store(Parameters{});
+}
 
 MarketImpactModel::~MarketImpactModel() = default;
 
@@ -13,62 +20,389 @@ void MarketImpactModel::initialize(double volatility,
                                  double dailyVolume,
                                  double permanentImpactFactor,
                                  double temporaryImpactFactor) {
-    volatility_ = volatility;
-    dailyVolume_ = dailyVolume;
-    permanentImpactFactor_ = permanentImpactFactor;
-    temporaryImpactFactor_ = temporaryImpactFactor;
+    updateParameters(volatility, dailyVolume, permanentImpactFactor, temporaryImpactFactor);
 }
 
 double MarketImpactModel::calculateMarketImpact(double orderSize,
                                               double currentPrice,
-                                              double timeHorizon) {
-    double tempImpact = temporaryImpactFactor_ * 
-                       std::sqrt(std::abs(orderSize) / dailyVolume_) * 
+                                              double /*timeHorizon*/) {
+    Parameters p = parameters_.load();
+    double participation = std::abs(orderSize) / p.dailyVolume;
+    double tempImpact = p.temporaryImpactFactor * 
+                       (p.impactExponent == 0.5 ? std::sqrt(participation) : std::pow(participation, p.impactExponent)) * 
                        currentPrice;
     
-    double permImpact = permanentImpactFactor_ * 
-                       (std::abs(orderSize) / dailyVolume_) * 
+    double permImpact = p.permanentImpactFactor * 
+                       participation * 
                        currentPrice;
     
     return tempImpact + permImpact;
 }
 
+void MarketImpactModel::calculateMarketImpactBatch(const double* orderSizes,
+                                                   size_t count,
+                                                   double currentPrice,
+                                                   double* impacts) const {
+    Parameters p = parameters_.load();
+    double permanent = p.permanentImpactFactor * currentPrice / p.dailyVolume;
+    double temporary = p.temporaryImpactFactor * currentPrice;
+    double inverseVolume = 1.0 / p.dailyVolume;
+
+    if (p.impactExponent == 0.5) {
+        double temporaryScaled = temporary * std::sqrt(inverseVolume);
+        for (size_t i = 0; i < count; ++i) {
+            double size = std::abs(orderSizes[i]);
+            impacts[i] = temporaryScaled * std::sqrt(size) + permanent * size;
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            double size = std::abs(orderSizes[i]);
+            impacts[i] = temporary * std::pow(size * inverseVolume, p.impactExponent) + permanent * size;
+        }
+    }
+}
+
+namespace {
+
+constexpr double kSecondsPerDay = 86400.0;
+constexpr double kMinHorizonSeconds = 1e-9;
+
+// Risk aversions evaluated together by evaluateLanes
+constexpr size_t kFrontierLanes = 16;
+
+} // namespace
+
+struct MarketImpactModel::ScheduleInputs {
+    size_t slices;
+    double totalSize;
+    double tau;          // Slice length, days
+    double sigma;        // Price volatility, quote currency per sqrt(day)
+    double gamma;        // Permanent impact, price per unit traded
+    double etaTilde;     // Temporary impact net of the permanent half-step
+};
+
+void MarketImpactModel::calculateScheduleCosts(const double* orderSizes,
+                                               const double* timeHorizons,
+                                               size_t count,
+                                               double currentPrice,
+                                               double* costs,
+                                               size_t numSlices) const {
+    Parameters p = parameters_.load();
+    double perUnit = p.dailyVolume > 0.0 ? currentPrice / p.dailyVolume : 0.0;
+    double permanent = 0.5 * p.permanentImpactFactor * perUnit * (1.0 - 1.0 / static_cast<double>(std::max<size_t>(numSlices, 1)));
+    double temporary = p.temporaryImpactFactor * perUnit * kSecondsPerDay;   // eta per horizon in seconds
+
+    for (size_t i = 0; i < count; ++i) {
+        double squared = orderSizes[i] * orderSizes[i];
+        costs[i] = squared * (permanent + temporary / std::max(timeHorizons[i], kMinHorizonSeconds));
+    }
+}
+
+// Discrete-time urgency: (2 / tau^2)(cosh(kappa tau) - 1) = lambda sigma^2 / eta~
+double MarketImpactModel::urgency(const ScheduleInputs& in, double riskAversion) {
+    if (riskAversion <= 0.0 || in.sigma <= 0.0) return 0.0;
+    if (in.etaTilde <= 0.0) return std::numeric_limits<double>::infinity();  // Trading is free: sell at once
+    double kappaTilde2 = riskAversion * in.sigma * in.sigma / in.etaTilde;
+    return std::acosh(0.5 * kappaTilde2 * in.tau * in.tau + 1.0) / in.tau;
+}
+
+// Fill holdings[0..slices] for one urgency and return cost and variance
+void MarketImpactModel::evaluate(const ScheduleInputs& in, double kappa, double* holdings, double& expectedCost, double& variance) {
+    const double horizon = in.tau * static_cast<double>(in.slices);
+    const double kT = kappa * horizon;
+
+    // sinh(k(T - t)) / sinh(kT) = e^{-kt} (1 - e^{-2k(T - t)}) / (1 - e^{-2kT}),
+    // which cannot overflow for steep schedules
+    const double denominator = -std::expm1(-2.0 * kT);
+    holdings[0] = in.totalSize;
+    for (size_t j = 1; j < in.slices; ++j) {
+        double t = in.tau * static_cast<double>(j);
+        double fraction = kT < 1e-8
+            ? 1.0 - t / horizon   // lambda -> 0: straight line (TWAP)
+            : std::exp(-kappa * t) * -std::expm1(-2.0 * kappa * (horizon - t)) / denominator;
+        holdings[j] = in.totalSize * fraction;
+    }
+    holdings[in.slices] = 0.0;
+
+    double tradeSquares = 0.0, holdingSquares = 0.0;
+    for (size_t j = 1; j <= in.slices; ++j) {
+        double trade = holdings[j - 1] - holdings[j];
+        tradeSquares += trade * trade;
+        holdingSquares += holdings[j] * holdings[j];
+    }
+    expectedCost = 0.5 * in.gamma * in.totalSize * in.totalSize + in.etaTilde / in.tau * tradeSquares;
+    variance = in.sigma * in.sigma * in.tau * holdingSquares;
+}
+
 std::vector<double> MarketImpactModel::calculateOptimalTrajectory(double totalSize,
                                                                 double timeHorizon,
-                                                                double riskAversion) {
-    std::vector<double> trajectory;
-    int steps = 10;
-    double stepSize = totalSize / steps;
-    
-    for (int i = 0; i < steps; ++i) {
-        trajectory.push_back(stepSize);
+                                                                double riskAversion,
+                                                                size_t numSlices) const {
+    return calculateExecutionTrajectory(totalSize, timeHorizon, riskAversion, numSlices).trades;
+}
+
+ExecutionTrajectory MarketImpactModel::calculateExecutionTrajectory(double totalSize,
+                                                                    double timeHorizon,
+                                                                    double riskAversion,
+                                                                    size_t numSlices,
+                                                                    double currentPrice) const {
+    numSlices = std::max<size_t>(numSlices, 1);
+    ScheduleInputs in = scheduleInputs(parameters_.load(), totalSize, timeHorizon, numSlices, currentPrice);
+
+    ExecutionTrajectory trajectory;
+    trajectory.kappa = urgency(in, riskAversion);
+    trajectory.holdings.resize(numSlices + 1);
+    evaluate(in, trajectory.kappa, trajectory.holdings.data(), trajectory.expectedCost, trajectory.variance);
+
+    trajectory.trades.resize(numSlices);
+    for (size_t j = 0; j < numSlices; ++j) {
+        trajectory.trades[j] = trajectory.holdings[j] - trajectory.holdings[j + 1];
     }
-    
     return trajectory;
 }
 
+void MarketImpactModel::calculateTrajectories(double totalSize,
+                                              double timeHorizon,
+                                              const double* riskAversions,
+                                              size_t count,
+                                              size_t numSlices,
+                                              double currentPrice,
+                                              double* holdings,
+                                              double* expectedCosts,
+                                              double* variances) const {
+    numSlices = std::max<size_t>(numSlices, 1);
+    ScheduleInputs in = scheduleInputs(parameters_.load(), totalSize, timeHorizon, numSlices, currentPrice);
+
+    // Only kappa depends on the risk aversion; everything else is shared
+    for (size_t i = 0; i < count; ++i) {
+        evaluate(in, urgency(in, riskAversions[i]), holdings + i * (numSlices + 1), expectedCosts[i], variances[i]);
+    }
+}
+
+// Cost and variance only, for up to kFrontierLanes urgencies at once. With
+// q = e^{-kappa tau} the holdings fraction is (q^j - q^{2N-j}) / (1 - q^{2N}),
+// so the slices need multiplies only: q^j is built forward into scratch
+// (lanes x (N - 1)) and q^{2N-j} backward while the sums accumulate.
+void MarketImpactModel::evaluateLanes(const ScheduleInputs& in, const double* kappas, size_t lanes, double* scratch,
+                                      double* expectedCosts, double* variances) {
+    const size_t n = in.slices;
+    const double horizon = in.tau * static_cast<double>(n);
+
+    double q[kFrontierLanes], scale[kFrontierLanes], tail[kFrontierLanes];
+    double linear[kFrontierLanes];   // 1 where the schedule is a straight line
+    double previous[kFrontierLanes], tradeSquares[kFrontierLanes], holdingSquares[kFrontierLanes];
+    for (size_t l = 0; l < kFrontierLanes; ++l) {
+        double kappa = l < lanes ? kappas[l] : 0.0;
+        double kT = kappa * horizon;
+        q[l] = std::exp(-kappa * in.tau);
+        scale[l] = in.totalSize / -std::expm1(-2.0 * kT);
+        tail[l] = std::exp(-kappa * in.tau * static_cast<double>(n + 1));   // q^{2N-j} at j = N - 1
+        linear[l] = kT < 1e-8 ? 1.0 : 0.0;
+        previous[l] = 0.0;   // Holdings after the last slice
+        tradeSquares[l] = 0.0;
+        holdingSquares[l] = 0.0;
+    }
+
+    if (n > 1) {
+        for (size_t l = 0; l < kFrontierLanes; ++l) scratch[l] = q[l];
+        for (size_t j = 2; j < n; ++j) {
+            double* row = scratch + (j - 1) * kFrontierLanes;
+            const double* before = row - kFrontierLanes;
+            for (size_t l = 0; l < kFrontierLanes; ++l) row[l] = before[l] * q[l];
+        }
+    }
+
+    for (size_t j = n - 1; j >= 1; --j) {
+        const double* row = scratch + (j - 1) * kFrontierLanes;
+        double straight = in.totalSize * (1.0 - static_cast<double>(j) / static_cast<double>(n));
+        for (size_t l = 0; l < kFrontierLanes; ++l) {
+            double curved = scale[l] * (row[l] - tail[l]);
+            double holding = linear[l] != 0.0 ? straight : curved;
+            double trade = holding - previous[l];
+            tradeSquares[l] += trade * trade;
+            holdingSquares[l] += holding * holding;
+            previous[l] = holding;
+            tail[l] *= q[l];
+        }
+    }
+
+    const double permanent = 0.5 * in.gamma * in.totalSize * in.totalSize;
+    for (size_t l = 0; l < lanes; ++l) {
+        double first = in.totalSize - previous[l];   // Traded in the first slice
+        expectedCosts[l] = permanent + in.etaTilde / in.tau * (tradeSquares[l] + first * first);
+        variances[l] = in.sigma * in.sigma * in.tau * holdingSquares[l];
+    }
+}
+
+EfficientFrontier MarketImpactModel::calculateEfficientFrontier(double totalSize,
+                                                                const std::vector<double>& riskAversions,
+                                                                const std::vector<double>& horizons,
+                                                                size_t numSlices,
+                                                                double currentPrice,
+                                                                ThreadPool* pool) const {
+    numSlices = std::max<size_t>(numSlices, 1);
+    EfficientFrontier frontier(riskAversions, horizons);
+    const Parameters parameters = parameters_.load();   // One set for the whole grid
+
+    const size_t blocksPerHorizon = (riskAversions.size() + kFrontierLanes - 1) / kFrontierLanes;
+    const size_t tasks = blocksPerHorizon * horizons.size();
+    double* costs = frontier.expectedCosts();
+    double* variances = frontier.variances();
+    double* kappas = frontier.kappas();
+
+    // One scratch buffer per thread, allocated before the loop; each thread
+    // then claims blocks from a shared counter so uneven horizons still balance
+    const size_t scratchSize = numSlices * kFrontierLanes;
+    const size_t threads = pool ? std::min(pool->concurrency(), std::max<size_t>(tasks, 1)) : 1;
+    std::vector<double> scratch(threads * scratchSize);
+    std::atomic<size_t> next{0};
+
+    auto worker = [&](size_t thread) {
+        double* threadScratch = scratch.data() + thread * scratchSize;
+        for (size_t t = next.fetch_add(1, std::memory_order_relaxed); t < tasks;
+             t = next.fetch_add(1, std::memory_order_relaxed)) {
+            size_t h = t / blocksPerHorizon;
+            size_t first = (t % blocksPerHorizon) * kFrontierLanes;
+            size_t lanes = std::min(kFrontierLanes, riskAversions.size() - first);
+            size_t cell = frontier.cellIndex(h, first);
+
+            ScheduleInputs in = scheduleInputs(parameters, totalSize, horizons[h], numSlices, currentPrice);
+            for (size_t l = 0; l < lanes; ++l) {
+                kappas[cell + l] = urgency(in, riskAversions[first + l]);
+            }
+            evaluateLanes(in, kappas + cell, lanes, threadScratch, costs + cell, variances + cell);
+        }
+    };
+
+    if (threads > 1) {
+        pool->parallelFor(threads, worker);
+    } else {
+        worker(0);
+    }
+    return frontier;
+}
+
+MarketImpactModel::ScheduleInputs MarketImpactModel::scheduleInputs(const Parameters& parameters,
+                                                                    double totalSize,
+                                                                    double timeHorizon,
+                                                                    size_t numSlices,
+                                                                    double currentPrice) {
+    ScheduleInputs in;
+    in.slices = numSlices;
+    in.totalSize = totalSize;
+    in.tau = std::max(timeHorizon, kMinHorizonSeconds) / kSecondsPerDay / static_cast<double>(numSlices);
+    in.sigma = parameters.volatility * currentPrice;
+
+    // Linear impacts scaled like calculateMarketImpact: factor * price per daily volume traded
+    double perUnit = parameters.dailyVolume > 0.0 ? currentPrice / parameters.dailyVolume : 0.0;
+    in.gamma = parameters.permanentImpactFactor * perUnit;
+    double eta = parameters.temporaryImpactFactor * perUnit;
+    in.etaTilde = eta - 0.5 * in.gamma * in.tau;
+    return in;
+}
+
 void MarketImpactModel::updateParameters(double volatility,
                                        double dailyVolume,
                                        double permanentImpactFactor,
                                        double temporaryImpactFactor) {
-    volatility_ = volatility;
-    dailyVolume_ = dailyVolume;
-    permanentImpactFactor_ = permanentImpactFactor;
-    temporaryImpactFactor_ = temporaryImpactFactor;
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    Parameters p = parameters_.load();
+    p.volatility = volatility;
+    p.dailyVolume = dailyVolume;
+    p.permanentImpactFactor = permanentImpactFactor;
+    p.temporaryImpactFactor = temporaryImpactFactor;
+    parameters_.store(p);
+}
+
+void MarketImpactModel::updateMarketConditions(double volatility, double dailyVolume) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    Parameters p = parameters_.load();
+    p.volatility = volatility;
+    p.dailyVolume = dailyVolume;
+    parameters_.store(p);
+}
+
+void MarketImpactModel::updateImpactFactors(double permanentImpactFactor,
+                                            double temporaryImpactFactor,
+                                            double impactExponent) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    Parameters p = parameters_.load();
+    p.permanentImpactFactor = permanentImpactFactor;
+    p.temporaryImpactFactor = temporaryImpactFactor;
+    p.impactExponent = impactExponent;
+    parameters_.store(p);
+}
+
+bool MarketImpactModel::saveParameters(const std::string& filename) const {
+    Parameters p = parameters_.load();
+    std::string temporary = filename + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        if (!out) return false;
+        out << std::setprecision(17)
+            << "permanentImpactFactor=" << p.permanentImpactFactor << "\n"
+            << "temporaryImpactFactor=" << p.temporaryImpactFactor << "\n"
+            << "impactExponent=" << p.impactExponent << "\n";
+        if (!out.flush()) return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, filename, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+bool MarketImpactModel::loadParameters(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in) return false;
+
+    Parameters loaded = parameters_.load();
+    bool found = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string key, text;
+        if (!std::getline(fields, key, '=') || !std::getline(fields, text)) return false;
+
+        double value;
+        if (DecimalParser::parseDouble(text, value) != DecimalParser::Status::Ok) return false;
+        if (key == "permanentImpactFactor") {
+            loaded.permanentImpactFactor = value;
+        } else if (key == "temporaryImpactFactor") {
+            loaded.temporaryImpactFactor = value;
+        } else if (key == "impactExponent") {
+            if (value <= 0.0) return false;
+            loaded.impactExponent = value;
+        } else {
+            continue;   // Written by a newer version
+        }
+        found = true;
+    }
+    if (!found) return false;
+
+    updateImpactFactors(loaded.permanentImpactFactor, loaded.temporaryImpactFactor, loaded.impactExponent);
+    return true;
 }
 
 double MarketImpactModel::getVolatility() const {
-    return volatility_;
+    return parameters_.load().volatility;
 }
 
 double MarketImpactModel::getDailyVolume() const {
-    return dailyVolume_;
+    return parameters_.load().dailyVolume;
 }
 
 double MarketImpactModel::getPermanentImpactFactor() const {
-    return permanentImpactFactor_;
+    return parameters_.load().permanentImpactFactor;
 }
 
 double MarketImpactModel::getTemporaryImpactFactor() const {
-    return temporaryImpactFactor_;
-} 
\ No newline at end of file
+    return parameters_.load().temporaryImpactFactor;
+}
+
+double MarketImpactModel::getImpactExponent() const {
+    return parameters_.load().impactExponent;
+}
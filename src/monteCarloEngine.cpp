@@ -0,0 +1,139 @@
+#include "monteCarloEngine.hpp"
+#include "philox.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kSecondsPerDay = 86400.0;
+// Paths advanced together through each slice
+constexpr size_t kLanes = 8;
+// Paths per pool task
+constexpr size_t kPathsPerTask = 512;
+
+// Per-run constants, in quote currency
+struct PathInputs {
+    const double* trades;
+    size_t slices;
+    double side;            // +1 buy, -1 sell
+    double startPrice;
+    double halfSpread;
+    double sigmaSqrtTau;    // Price move per slice, one standard deviation
+    double gamma;           // Permanent impact per unit
+    double etaOverTau;      // Temporary impact per unit of slice quantity
+    double feeRate;
+    double fillProbability;
+    Philox4x32::Key key;
+};
+
+// Shortfall of paths [first, first + count), count <= kLanes
+void simulateLanes(const PathInputs& in, size_t first, size_t count, double* costs) {
+    double price[kLanes], carry[kLanes], cost[kLanes];
+    double shock[kLanes], fills[kLanes];
+    uint32_t c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+    for (size_t l = 0; l < kLanes; ++l) {
+        price[l] = in.startPrice;
+        carry[l] = 0.0;
+        cost[l] = 0.0;
+    }
+
+    for (size_t k = 0; k < in.slices; ++k) {
+        const bool last = k + 1 == in.slices;
+        for (size_t l = 0; l < kLanes; ++l) {
+            uint64_t path = first + l;
+            c0[l] = static_cast<uint32_t>(path);
+            c1[l] = static_cast<uint32_t>(path >> 32);
+            c2[l] = static_cast<uint32_t>(k);
+            c3[l] = 0u;
+        }
+        Philox4x32::generate(c0, c1, c2, c3, kLanes, in.key);
+        for (size_t l = 0; l < kLanes; ++l) {
+            shock[l] = in.sigmaSqrtTau * Philox4x32::toNormal(c0[l], c1[l]);
+            fills[l] = last || Philox4x32::toUniform(c2[l]) < in.fillProbability ? 1.0 : 0.0;
+        }
+
+        const double planned = in.trades[k];
+        for (size_t l = 0; l < kLanes; ++l) {
+            double attempted = planned + carry[l];
+            double filled = attempted * fills[l];
+            carry[l] = attempted - filled;
+            double executed = price[l] + in.side * (in.halfSpread + in.etaOverTau * filled);
+            cost[l] += in.side * filled * (executed - in.startPrice) + in.feeRate * filled * executed;
+            price[l] += shock[l] + in.side * in.gamma * filled;
+        }
+    }
+
+    for (size_t l = 0; l < count; ++l) costs[l] = cost[l];
+}
+
+} // namespace
+
+CostDistribution MonteCarloEngine::simulate(double orderSize,
+                                            const std::vector<double>& trades,
+                                            double timeHorizon,
+                                            const Market& market,
+                                            const Config& config,
+                                            ThreadPool* pool) {
+    CostDistribution result;
+    result.levels = config.levels;
+    result.valueAtRisk.assign(config.levels.size(), 0.0);
+    result.expectedShortfall.assign(config.levels.size(), 0.0);
+    if (config.paths == 0 || trades.empty()) return result;
+
+    std::vector<double> quantities(trades.size());
+    for (size_t k = 0; k < trades.size(); ++k) quantities[k] = std::abs(trades[k]);
+
+    const double tau = std::max(timeHorizon, 1e-9) / kSecondsPerDay / static_cast<double>(trades.size());
+    const double perUnit = market.dailyVolume > 0.0 ? market.midPrice / market.dailyVolume : 0.0;
+
+    PathInputs in;
+    in.trades = quantities.data();
+    in.slices = quantities.size();
+    in.side = orderSize < 0.0 ? -1.0 : 1.0;
+    in.startPrice = market.midPrice;
+    in.halfSpread = market.halfSpread;
+    in.sigmaSqrtTau = market.volatility * market.midPrice * std::sqrt(tau);
+    in.gamma = market.permanentImpactFactor * perUnit;
+    in.etaOverTau = market.temporaryImpactFactor * perUnit / tau;
+    in.feeRate = market.feeRate;
+    in.fillProbability = std::clamp(config.fillProbability, 0.0, 1.0);
+    in.key = Philox4x32::keyFromSeed(config.seed);
+
+    // Every path writes its own slot, so the split across threads cannot change the result
+    std::vector<double> costs(config.paths);
+    const size_t tasks = (config.paths + kPathsPerTask - 1) / kPathsPerTask;
+    auto task = [&](size_t t) {
+        size_t end = std::min((t + 1) * kPathsPerTask, config.paths);
+        for (size_t first = t * kPathsPerTask; first < end; first += kLanes) {
+            simulateLanes(in, first, std::min(kLanes, end - first), costs.data() + first);
+        }
+    };
+    if (pool) {
+        pool->parallelFor(tasks, task);
+    } else {
+        for (size_t t = 0; t < tasks; ++t) task(t);
+    }
+
+    const double n = static_cast<double>(config.paths);
+    double sum = 0.0;
+    for (double cost : costs) sum += cost;
+    result.paths = config.paths;
+    result.mean = sum / n;
+    double squares = 0.0;
+    for (double cost : costs) squares += (cost - result.mean) * (cost - result.mean);
+    result.stdDev = config.paths > 1 ? std::sqrt(squares / (n - 1.0)) : 0.0;
+
+    // VaR is the empirical quantile; ES averages the tail from it onwards
+    std::sort(costs.begin(), costs.end());
+    for (size_t i = 0; i < config.levels.size(); ++i) {
+        double level = std::clamp(config.levels[i], 0.0, 1.0);
+        size_t index = std::min(static_cast<size_t>(std::ceil(level * n)), config.paths);
+        index = index > 0 ? index - 1 : 0;
+        result.valueAtRisk[i] = costs[index];
+        double tail = 0.0;
+        for (size_t j = index; j < costs.size(); ++j) tail += costs[j];
+        result.expectedShortfall[i] = tail / static_cast<double>(costs.size() - index);
+    }
+    return result;
+}
@@ -1,164 +1,311 @@
 #include "orderbook.hpp"
-#include <sstream>
-#include <iomanip>
-#include <ctime>
 #include <algorithm>
+#include <limits>
 
-OrderBook::OrderBook(const std::string& exchange, const std::string& symbol)
-    : exchange_(exchange), symbol_(symbol) {}
+OrderBook::OrderBook(const std::string& exchange, const std::string& symbol, double tickSize)
+    : exchange_(exchange)
+    , symbol_(symbol)
+    , tickSize_(tickSize > 0.0 ? tickSize : kDefaultTickSize)
+    , priceParser_(tickSize_)
+    , asks_(false)
+    , bids_(true) {}
 
 void OrderBook::update(const std::string& timestamp,
                       const std::vector<std::pair<std::string, std::string>>& asks,
                       const std::vector<std::pair<std::string, std::string>>& bids) {
     std::lock_guard<std::mutex> lock(mutex_);
     
-    lastUpdateTime_ = parseTimestamp(timestamp);
+    stampUpdate(timestamp);
     
     updateSide(asks_, asks);
     updateSide(bids_, bids);
+    publishTopOfBook();
 }
 
-void OrderBook::updateSide(PriceLevels& side, const std::vector<std::pair<std::string, std::string>>& levels) {
+void OrderBook::updateSide(PriceLadder& side, const std::vector<std::pair<std::string, std::string>>& levels) {
     side.clear();
     
     for(const auto& level : levels) {
-        double price = parsePrice(level.first);
-        double quantity = parseQuantity(level.second);
-        if(quantity > 0){ 
+        int64_t tick;
+        double quantity;
+        if(parseLevel(level, tick, quantity) && quantity > 0){ 
              // Only insert non-zero quantities
-            side[price] = quantity;
+            side.set(tick, quantity);
         }
     }
 }
 
-std::optional<PriceLevel> OrderBook::getBestAsk() const {
+void OrderBook::applyDelta(const std::string& timestamp,
+                           const std::vector<std::pair<std::string, std::string>>& asks,
+                           const std::vector<std::pair<std::string, std::string>>& bids) {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (asks_.empty()) return std::nullopt;
-    auto it = asks_.begin();
-    return PriceLevel(it->first, it->second);
+    
+    stampUpdate(timestamp);
+    
+    applySideDelta(asks_, asks);
+    applySideDelta(bids_, bids);
+    publishTopOfBook();
 }
 
-std::optional<PriceLevel> OrderBook::getBestBid() const {
+void OrderBook::applySideDelta(PriceLadder& side, const std::vector<std::pair<std::string, std::string>>& levels) {
+    for (const auto& level : levels) {
+        int64_t tick;
+        double quantity;
+        if (parseLevel(level, tick, quantity)) {
+            // A zero quantity removes the level
+            side.set(tick, quantity);
+        }
+    }
+}
+
+void OrderBook::update(const std::string& timestamp,
+                      const std::vector<TickLevel>& asks,
+                      const std::vector<TickLevel>& bids) {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (bids_.empty()) return std::nullopt;
-    auto it = bids_.begin();
-    return PriceLevel(it->first, it->second);
+    
+    stampUpdate(timestamp);
+    
+    updateSide(asks_, asks);
+    updateSide(bids_, bids);
+    publishTopOfBook();
 }
 
-std::vector<PriceLevel> OrderBook::getAsksAtDepth(size_t depth) const {
+void OrderBook::applyDelta(const std::string& timestamp,
+                           const std::vector<TickLevel>& asks,
+                           const std::vector<TickLevel>& bids) {
     std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<PriceLevel> result;
-    result.reserve(std::min(depth, asks_.size()));
     
-    auto it = asks_.begin();
-    for (size_t i = 0; i < depth && it != asks_.end(); ++i, ++it) {
-        result.emplace_back(it->first, it->second);
+    stampUpdate(timestamp);
+    
+    applySideDelta(asks_, asks);
+    applySideDelta(bids_, bids);
+    publishTopOfBook();
+}
+
+void OrderBook::updateSide(PriceLadder& side, const std::vector<TickLevel>& levels) {
+    side.clear();
+    
+    for (const auto& level : levels) {
+        if (level.quantity > 0) {
+            side.set(level.tick, level.quantity);
+        }
+    }
+}
+
+void OrderBook::applySideDelta(PriceLadder& side, const std::vector<TickLevel>& levels) {
+    for (const auto& level : levels) {
+        side.set(level.tick, level.quantity);
+    }
+}
+
+std::optional<PriceLevel> OrderBook::getBestAsk() const {
+    TopOfBook top = topOfBook_.load();
+    if (!top.hasAsk) return std::nullopt;
+    return PriceLevel(top.askPrice, top.askQuantity);
+}
+
+std::optional<PriceLevel> OrderBook::getBestBid() const {
+    TopOfBook top = topOfBook_.load();
+    if (!top.hasBid) return std::nullopt;
+    return PriceLevel(top.bidPrice, top.bidQuantity);
+}
+
+BookView OrderBook::view(size_t depth) const {
+    depth = std::min(depth, BookView::kMaxDepth);
+    BookView result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fillViewSide(bids_, depth, result.bids);
+        fillViewSide(asks_, depth, result.asks);
+    }
+    if (result.isTwoSided()) {
+        result.midPrice = (result.asks.prices[0] + result.bids.prices[0]) / 2.0;
+        result.spread = result.asks.prices[0] - result.bids.prices[0];
     }
     return result;
 }
 
+void OrderBook::fillViewSide(const PriceLadder& side, size_t depth, BookView::Side& out) const {
+    size_t n = 0;
+    double cumulative = 0.0;
+    side.forEachLevel(depth, [&](int64_t tick, double quantity) {
+        cumulative += quantity;
+        out.prices[n] = toPrice(tick);
+        out.quantities[n] = quantity;
+        out.cumulativeQuantities[n] = cumulative;
+        ++n;
+    });
+    out.depth = n;
+}
+
+std::vector<PriceLevel> OrderBook::getAsksAtDepth(size_t depth) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return levelsAtDepth(asks_, depth);
+}
+
 std::vector<PriceLevel> OrderBook::getBidsAtDepth(size_t depth) const {
     std::lock_guard<std::mutex> lock(mutex_);
+    return levelsAtDepth(bids_, depth);
+}
+
+std::vector<PriceLevel> OrderBook::getAsks() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return levelsAtDepth(asks_, asks_.levelCount());
+}
+
+std::vector<PriceLevel> OrderBook::getBids() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return levelsAtDepth(bids_, bids_.levelCount());
+}
+
+std::vector<PriceLevel> OrderBook::levelsAtDepth(const PriceLadder& side, size_t depth) const {
     std::vector<PriceLevel> result;
-    result.reserve(std::min(depth, bids_.size()));
+    result.reserve(std::min(depth, side.levelCount()));
     
-    auto it = bids_.begin();
-    for (size_t i = 0; i < depth && it != bids_.end(); ++i, ++it) {
-        result.emplace_back(it->first, it->second);
-    }
+    side.forEachLevel(depth, [&](int64_t tick, double quantity) {
+        result.emplace_back(toPrice(tick), quantity);
+    });
     return result;
 }
 
 double OrderBook::getMidPrice() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (asks_.empty() || bids_.empty()) return 0.0;
-    
-    auto bestAsk = asks_.begin();
-    auto bestBid = bids_.begin();
-    
-    return (bestAsk->first + bestBid->first) / 2.0;
+    return topOfBook_.load().midPrice();
 }
 
 double OrderBook::getSpread() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (asks_.empty() || bids_.empty()) return 0.0;
-    
-    auto bestAsk = asks_.begin();
-    auto bestBid = bids_.begin();
-    
-    return bestAsk->first - bestBid->first;
+    return topOfBook_.load().spread();
 }
 
 double OrderBook::getVolumeAtPrice(double price) const {
     std::lock_guard<std::mutex> lock(mutex_);
+    int64_t tick = toTick(price);
     
     // Check asks
-    auto askIt = asks_.find(price);
-    if (askIt != asks_.end()) {
-        return askIt->second;
+    double askQuantity = asks_.quantityAt(tick);
+    if (askQuantity > 0.0) {
+        return askQuantity;
     }
     
     // Check bids
-    auto bidIt = bids_.find(price);
-    if (bidIt != bids_.end()) {
-        return bidIt->second;
-    }
-    
-    return 0.0;
+    return bids_.quantityAt(tick);
 }
 
 double OrderBook::getVolumeBetweenPrices(double lowerPrice, double upperPrice) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    double totalVolume = 0.0;
     
-    //Sum ask volume
-    for (const auto& [price, quantity] : asks_) {
-        if (price >= lowerPrice && price <= upperPrice) {
-            totalVolume += quantity;
-        }
-    }
+    // Only ticks that lie inside [lowerPrice, upperPrice] count
+    int64_t lowTick = static_cast<int64_t>(std::ceil(lowerPrice / tickSize_ - 1e-9));
+    int64_t highTick = static_cast<int64_t>(std::floor(upperPrice / tickSize_ + 1e-9));
+    if (lowTick > highTick) return 0.0;
     
-    //Sum bid volume
-    for (const auto& [price, quantity] : bids_) {
-        if (price >= lowerPrice && price <= upperPrice) {
-            totalVolume += quantity;
-        }
+    return asks_.volumeBetween(lowTick, highTick) + bids_.volumeBetween(lowTick, highTick);
+}
+
+std::optional<double> OrderBook::getSweepPrice(BookSide side, double quantity) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    int64_t tick;
+    if (!(side == BookSide::Ask ? asks_ : bids_).sweepTick(quantity, tick)) return std::nullopt;
+    return toPrice(tick);
+}
+
+void OrderBook::getSweepPrices(BookSide side, const double* quantities, double* prices, size_t count) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const PriceLadder& ladder = (side == BookSide::Ask) ? asks_ : bids_;
+    for (size_t i = 0; i < count; ++i) {
+        int64_t tick;
+        prices[i] = ladder.sweepTick(quantities[i], tick) ? toPrice(tick)
+                                                          : std::numeric_limits<double>::quiet_NaN();
     }
-    
-    return totalVolume;
 }
 
-double OrderBook::getBidVolume() const {
+double OrderBook::getVolumeWithinBps(BookSide side, double bps) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    double total = 0.0;
-    for (const auto& [price, quantity] : bids_) {
-        total += quantity;
+
+    if (asks_.empty() || bids_.empty() || bps < 0.0) return 0.0;
+
+    // Bound the side by the furthest tick still inside the band around the mid
+    double mid = toPrice(asks_.bestTick() + bids_.bestTick()) / 2.0;
+    double offset = mid * bps / 10000.0;
+    if (side == BookSide::Ask) {
+        int64_t limitTick = static_cast<int64_t>(std::floor((mid + offset) / tickSize_ + 1e-9));
+        return asks_.volumeBetween(asks_.bestTick(), limitTick);
     }
-    return total;
+    int64_t limitTick = static_cast<int64_t>(std::ceil((mid - offset) / tickSize_ - 1e-9));
+    return bids_.volumeBetween(limitTick, bids_.bestTick());
+}
+
+double OrderBook::getBidVolume() const {
+    return topOfBook_.load().bidVolume;
 }
 
 double OrderBook::getAskVolume() const {
+    return topOfBook_.load().askVolume;
+}
+
+double OrderBook::getImbalance() const {
+    return topOfBook_.load().imbalance();
+}
+
+void OrderBook::publishTopOfBook() {
+    bids_.refreshDepthVolumes();
+    asks_.refreshDepthVolumes();
+
+    TopOfBook top;
+    top.hasBid = !bids_.empty();
+    top.hasAsk = !asks_.empty();
+    if (top.hasBid) {
+        top.bidPrice = toPrice(bids_.bestTick());
+        top.bidQuantity = bids_.bestQuantity();
+    }
+    if (top.hasAsk) {
+        top.askPrice = toPrice(asks_.bestTick());
+        top.askQuantity = asks_.bestQuantity();
+    }
+    top.bidVolume = bids_.totalVolume();
+    top.askVolume = asks_.totalVolume();
+    for (size_t i = 0; i < PriceLadder::kTrackedDepths.size(); ++i) {
+        top.bidDepthVolume[i] = bids_.trackedDepthVolume(i);
+        top.askDepthVolume[i] = asks_.trackedDepthVolume(i);
+    }
+    topOfBook_.store(top);
+}
+
+uint64_t OrderBook::getParseErrorCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return parseErrors_;
+}
+
+uint64_t OrderBook::getDroppedLevelCount() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    double total = 0.0;
-    for (const auto& [price, quantity] : asks_) {
-        total += quantity;
+    return asks_.droppedLevels() + bids_.droppedLevels();
+}
+
+bool OrderBook::parseLevel(const std::pair<std::string, std::string>& level, int64_t& tick, double& quantity) {
+    if (priceParser_.parseUnits(level.first, tick) != DecimalParser::Status::Ok ||
+        DecimalParser::parseDouble(level.second, quantity) != DecimalParser::Status::Ok) {
+        ++parseErrors_;
+        return false;
     }
-    return total;
+    return true;
 }
 
-double OrderBook::parsePrice(const std::string& price) {
-    return std::stod(price);
+OrderBook::Timestamp OrderBook::getLastUpdateTime() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastUpdateTime_;
 }
 
-double OrderBook::parseQuantity(const std::string& quantity) {
-    return std::stod(quantity);
+std::chrono::nanoseconds OrderBook::getFeedLatency() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastReceiveTime_ - lastUpdateTime_;
 }
 
-OrderBook::Timestamp OrderBook::parseTimestamp(const std::string& timestamp) {
-    std::tm tm = {};
-    std::stringstream ss(timestamp);
-    ss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%SZ");
-    
-    auto time = std::chrono::system_clock::from_time_t(std::mktime(&tm));
-    return time;
-} 
\ No newline at end of file
+void OrderBook::stampUpdate(const std::string& timestamp) {
+    lastReceiveTime_ = std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now());
+
+    // Fall back to the receive time when the message carries no usable timestamp
+    if (!timestampParser_.parse(timestamp, lastUpdateTime_)) {
+        lastUpdateTime_ = lastReceiveTime_;
+    }
+}
@@ -0,0 +1,268 @@
+#include "priceLadder.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace {
+// Spare slots reserved around the occupied range when the ladder grows
+constexpr int64_t kHeadroom = 1024;
+}
+
+PriceLadder::PriceLadder(bool isBid)
+    : isBid_(isBid)
+    , baseKey_(0)
+    , fenwickTopBit_(0)
+    , bestIndex_(0)
+    , worstIndex_(0)
+    , levelCount_(0)
+    , totalQuantity_(0.0)
+    , depthVolumes_{}
+    , depthBoundary_(0)
+    , depthVolumesDirty_(false)
+    , droppedLevels_(0)
+    , touchedLow_(std::numeric_limits<size_t>::max())
+    , touchedHigh_(0) {}
+
+void PriceLadder::set(int64_t tick, double quantity) {
+    const int64_t key = toKey(tick);
+    const int64_t size = static_cast<int64_t>(quantities_.size());
+
+    if (quantity <= 0.0) {
+        int64_t offset = key - baseKey_;
+        if (levelCount_ == 0 || offset < 0 || offset >= size) return;
+
+        size_t index = static_cast<size_t>(offset);
+        if (quantities_[index] <= 0.0) return;
+        totalQuantity_ -= quantities_[index];
+        fenwickAdd(index, -quantities_[index]);
+        quantities_[index] = 0.0;
+        markDepthChange(index);
+
+        if (--levelCount_ == 0) {
+            bestIndex_ = worstIndex_ = 0;
+            totalQuantity_ = 0.0;
+        } else if (index == bestIndex_) {
+            while (quantities_[bestIndex_] <= 0.0) ++bestIndex_;
+        } else if (index == worstIndex_) {
+            while (quantities_[worstIndex_] <= 0.0) --worstIndex_;
+        }
+        return;
+    }
+
+    if (levelCount_ == 0) {
+        // Centre the window on the first level; slots emptied one by one may
+        // have left rounding residue in the tree, which must not move with it
+        if (quantities_.empty()) {
+            quantities_.assign(2 * kHeadroom, 0.0);
+            rebuildFenwick();
+        } else {
+            zeroTouched();
+        }
+        baseKey_ = key - static_cast<int64_t>(quantities_.size()) / 2;
+    } else {
+        const int64_t bestKey = baseKey_ + static_cast<int64_t>(bestIndex_);
+        if (key - bestKey >= kMaxSpan) {
+            ++droppedLevels_;  // Too deep behind the touch to be worth storing
+            return;
+        }
+
+        if (key < baseKey_) {
+            // New level in front of the window: shift down, dropping anything that
+            // would end up more than kMaxSpan behind the new best
+            int64_t newBase = key - kHeadroom;
+            int64_t newEnd = std::min(baseKey_ + size, key + kMaxSpan);
+            rebase(newBase, static_cast<size_t>(newEnd - newBase));
+        } else if (key >= baseKey_ + size) {
+            // Grow behind the window, releasing the slots the touch has moved
+            // away from so the window tracks the book rather than the drift
+            int64_t newBase = std::max(baseKey_, bestKey - kHeadroom);
+            int64_t needed = key - newBase + 1;
+            rebase(newBase, static_cast<size_t>(needed + std::max(kHeadroom, needed / 2)));
+        }
+    }
+
+    size_t index = static_cast<size_t>(key - baseKey_);
+    if (quantities_[index] <= 0.0) {
+        if (levelCount_ == 0) {
+            bestIndex_ = worstIndex_ = index;
+        } else {
+            bestIndex_ = std::min(bestIndex_, index);
+            worstIndex_ = std::max(worstIndex_, index);
+        }
+        ++levelCount_;
+    }
+    totalQuantity_ += quantity - quantities_[index];
+    fenwickAdd(index, quantity - quantities_[index]);
+    quantities_[index] = quantity;
+    markDepthChange(index);
+}
+
+void PriceLadder::clear() {
+    zeroTouched();
+    bestIndex_ = worstIndex_ = 0;
+    levelCount_ = 0;
+    totalQuantity_ = 0.0;
+    depthVolumesDirty_ = true;
+}
+
+// Zero every slot changed since the tree was last rebuilt or zeroed, and every
+// Fenwick node covering one. Slots emptied earlier by add/subtract cycles can
+// leave rounding residue in their nodes; assigning zero removes it. The nodes
+// covering [low, high] are those inside it plus the ancestors of high.
+void PriceLadder::zeroTouched() {
+    if (touchedLow_ > touchedHigh_) return;
+    std::fill(quantities_.begin() + touchedLow_, quantities_.begin() + touchedHigh_ + 1, 0.0);
+    std::fill(fenwick_.begin() + touchedLow_, fenwick_.begin() + touchedHigh_ + 1, 0.0);
+    const size_t n = fenwick_.size();
+    for (size_t i = touchedHigh_ + 1; i <= n; i += i & (~i + 1)) {
+        fenwick_[i - 1] = 0.0;
+    }
+    touchedLow_ = std::numeric_limits<size_t>::max();
+    touchedHigh_ = 0;
+}
+
+double PriceLadder::quantityAt(int64_t tick) const {
+    int64_t offset = toKey(tick) - baseKey_;
+    if (offset < 0 || offset >= static_cast<int64_t>(quantities_.size())) return 0.0;
+    return quantities_[static_cast<size_t>(offset)];
+}
+
+double PriceLadder::volumeBetween(int64_t lowTick, int64_t highTick) const {
+    if (levelCount_ == 0) return 0.0;
+
+    int64_t firstKey = std::min(toKey(lowTick), toKey(highTick));
+    int64_t lastKey = std::max(toKey(lowTick), toKey(highTick));
+    firstKey = std::max(firstKey, baseKey_ + static_cast<int64_t>(bestIndex_));
+    lastKey = std::min(lastKey, baseKey_ + static_cast<int64_t>(worstIndex_));
+    if (firstKey > lastKey) return 0.0;
+
+    size_t first = static_cast<size_t>(firstKey - baseKey_);
+    size_t last = static_cast<size_t>(lastKey - baseKey_);
+    double volume = prefixVolume(last) - (first > 0 ? prefixVolume(first - 1) : 0.0);
+    return std::max(volume, 0.0);
+}
+
+bool PriceLadder::sweepTick(double quantity, int64_t& tick) const {
+    if (levelCount_ == 0 || quantity > totalQuantity_ * (1.0 + 1e-12)) return false;
+
+    size_t index = bestIndex_;
+    if (quantity > 0.0) {
+        index = std::min(std::max(lowerBound(quantity), bestIndex_), worstIndex_);
+        // Rounding in the tree can land on an empty slot just before the level
+        while (quantities_[index] <= 0.0 && index < worstIndex_) ++index;
+    }
+    tick = fromKey(baseKey_ + static_cast<int64_t>(index));
+    return true;
+}
+
+void PriceLadder::refreshDepthVolumes() {
+    if (!depthVolumesDirty_) return;
+
+    // Walk the best levels once, recording the running sum at each tracked depth
+    size_t bucket = 0;
+    size_t visited = 0;
+    double cumulative = 0.0;
+    depthBoundary_ = bestIndex_;
+    for (size_t i = bestIndex_; visited < levelCount_ && bucket < kTrackedDepths.size(); ++i) {
+        if (quantities_[i] > 0.0) {
+            cumulative += quantities_[i];
+            depthBoundary_ = i;
+            if (++visited == kTrackedDepths[bucket]) {
+                depthVolumes_[bucket++] = cumulative;
+            }
+        }
+    }
+    // Fewer levels than the deeper buckets: they cover the whole side
+    for (; bucket < kTrackedDepths.size(); ++bucket) {
+        depthVolumes_[bucket] = cumulative;
+    }
+    depthVolumesDirty_ = false;
+}
+
+void PriceLadder::markDepthChange(size_t index) {
+    // Changes behind the deepest tracked level do not move any tracked sum,
+    // unless the side is too thin to fill the deepest bucket
+    if (index <= depthBoundary_ || levelCount_ <= kTrackedDepths.back()) {
+        depthVolumesDirty_ = true;
+    }
+}
+
+void PriceLadder::rebase(int64_t newBaseKey, size_t newSize) {
+    std::vector<double> moved(newSize, 0.0);
+
+    const int64_t from = std::max(baseKey_, newBaseKey);
+    const int64_t to = std::min(baseKey_ + static_cast<int64_t>(quantities_.size()),
+                                newBaseKey + static_cast<int64_t>(newSize));
+    if (from < to) {
+        std::copy(quantities_.begin() + (from - baseKey_),
+                  quantities_.begin() + (to - baseKey_),
+                  moved.begin() + (from - newBaseKey));
+    }
+
+    quantities_.swap(moved);
+    baseKey_ = newBaseKey;
+
+    // Levels may have been dropped off the deep end, so recount
+    const size_t previousCount = levelCount_;
+    bestIndex_ = worstIndex_ = 0;
+    levelCount_ = 0;
+    totalQuantity_ = 0.0;
+    for (size_t i = 0; i < quantities_.size(); ++i) {
+        if (quantities_[i] > 0.0) {
+            if (levelCount_ == 0) bestIndex_ = i;
+            worstIndex_ = i;
+            ++levelCount_;
+            totalQuantity_ += quantities_[i];
+        }
+    }
+    droppedLevels_ += previousCount - levelCount_;
+    rebuildFenwick();
+    depthVolumesDirty_ = true;
+}
+
+void PriceLadder::rebuildFenwick() {
+    // Linear-time construction: push each node's sum into its parent
+    const size_t n = quantities_.size();
+    fenwick_.assign(quantities_.begin(), quantities_.end());
+    for (size_t i = 1; i <= n; ++i) {
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= n) fenwick_[parent - 1] += fenwick_[i - 1];
+    }
+
+    fenwickTopBit_ = 1;
+    while (fenwickTopBit_ * 2 <= n) fenwickTopBit_ *= 2;
+
+    // The rebuilt tree is exact; only the occupied slots need zeroing later
+    touchedLow_ = levelCount_ > 0 ? bestIndex_ : std::numeric_limits<size_t>::max();
+    touchedHigh_ = levelCount_ > 0 ? worstIndex_ : 0;
+}
+
+void PriceLadder::fenwickAdd(size_t index, double delta) {
+    touchedLow_ = std::min(touchedLow_, index);
+    touchedHigh_ = std::max(touchedHigh_, index);
+    const size_t n = fenwick_.size();
+    for (size_t i = index + 1; i <= n; i += i & (~i + 1)) {
+        fenwick_[i - 1] += delta;
+    }
+}
+
+double PriceLadder::prefixVolume(size_t index) const {
+    double total = 0.0;
+    for (size_t i = index + 1; i > 0; i -= i & (~i + 1)) {
+        total += fenwick_[i - 1];
+    }
+    return total;
+}
+
+size_t PriceLadder::lowerBound(double target) const {
+    // Descend the implicit tree, keeping every prefix that stays below target
+    const size_t n = fenwick_.size();
+    size_t position = 0;
+    for (size_t step = fenwickTopBit_; step > 0; step >>= 1) {
+        size_t next = position + step;
+        if (next <= n && fenwick_[next - 1] < target) {
+            position = next;
+            target -= fenwick_[next - 1];
+        }
+    }
+    return position;
+}
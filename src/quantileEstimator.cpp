@@ -0,0 +1,358 @@
+#include "quantileEstimator.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+// Treap keyed by value with subtree sizes, stored in flat arrays with a free
+// list so steady-state insert/remove cycles do not allocate.
+class OrderStatisticTree {
+public:
+    void insert(double key) {
+        int32_t node = allocate(key);
+        int32_t left, right;
+        split(root_, key, left, right);
+        root_ = merge(merge(left, node), right);
+    }
+
+    // Remove one occurrence of key; returns false if it is not present
+    bool remove(double key) {
+        int32_t left, rest, match, right;
+        split(root_, key, left, rest);          // left < key <= rest
+        splitFirst(rest, match, right);         // match = smallest of rest
+        if (match != kNull && nodes_[match].key == key) {
+            free_.push_back(match);
+            root_ = merge(left, right);
+            return true;
+        }
+        root_ = merge(left, merge(match, right));
+        return false;
+    }
+
+    // Build a balanced tree over ascending keys in O(n). Priorities fall with
+    // depth so the heap order holds; later inserts settle in below as usual.
+    void assignSorted(const double* keys, size_t count) {
+        clear();
+        nodes_.resize(count);
+        root_ = build(keys, 0, count, 0);
+    }
+
+    // k-th smallest key, 0-based; k must be < size()
+    double select(size_t k) const {
+        int32_t node = root_;
+        while (true) {
+            size_t leftSize = sizeOf(nodes_[node].left);
+            if (k < leftSize) {
+                node = nodes_[node].left;
+            } else if (k == leftSize) {
+                return nodes_[node].key;
+            } else {
+                k -= leftSize + 1;
+                node = nodes_[node].right;
+            }
+        }
+    }
+
+    size_t size() const { return sizeOf(root_); }
+
+    void clear() {
+        nodes_.clear();
+        free_.clear();
+        root_ = kNull;
+    }
+
+private:
+    static constexpr int32_t kNull = -1;
+
+    struct Node {
+        double key;
+        uint32_t priority;
+        uint32_t size;
+        int32_t left;
+        int32_t right;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<int32_t> free_;
+    int32_t root_ = kNull;
+    uint32_t seed_ = 0x9e3779b9u;
+
+    size_t sizeOf(int32_t node) const { return node == kNull ? 0 : nodes_[node].size; }
+
+    void resize(int32_t node) {
+        nodes_[node].size = static_cast<uint32_t>(1 + sizeOf(nodes_[node].left) + sizeOf(nodes_[node].right));
+    }
+
+    uint32_t nextPriority() {
+        // xorshift32
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 17;
+        seed_ ^= seed_ << 5;
+        return seed_;
+    }
+
+    int32_t allocate(double key) {
+        Node node{key, nextPriority(), 1, kNull, kNull};
+        if (!free_.empty()) {
+            int32_t index = free_.back();
+            free_.pop_back();
+            nodes_[index] = node;
+            return index;
+        }
+        nodes_.push_back(node);
+        return static_cast<int32_t>(nodes_.size() - 1);
+    }
+
+    // left: keys < key, right: keys >= key
+    void split(int32_t node, double key, int32_t& left, int32_t& right) {
+        if (node == kNull) {
+            left = right = kNull;
+        } else if (nodes_[node].key < key) {
+            split(nodes_[node].right, key, nodes_[node].right, right);
+            left = node;
+            resize(node);
+        } else {
+            split(nodes_[node].left, key, left, nodes_[node].left);
+            right = node;
+            resize(node);
+        }
+    }
+
+    // first: the smallest node alone, rest: everything else
+    void splitFirst(int32_t node, int32_t& first, int32_t& rest) {
+        if (node == kNull) {
+            first = rest = kNull;
+        } else if (nodes_[node].left == kNull) {
+            first = node;
+            rest = nodes_[node].right;
+            nodes_[node].right = kNull;
+            resize(node);
+        } else {
+            splitFirst(nodes_[node].left, first, nodes_[node].left);
+            rest = node;
+            resize(node);
+        }
+    }
+
+    int32_t build(const double* keys, size_t begin, size_t end, uint32_t depth) {
+        if (begin == end) return kNull;
+        size_t mid = begin + (end - begin) / 2;
+        int32_t left = build(keys, begin, mid, depth + 1);
+        int32_t right = build(keys, mid + 1, end, depth + 1);
+        nodes_[mid] = {keys[mid], UINT32_MAX - depth, static_cast<uint32_t>(end - begin), left, right};
+        return static_cast<int32_t>(mid);
+    }
+
+    int32_t merge(int32_t left, int32_t right) {
+        if (left == kNull) return right;
+        if (right == kNull) return left;
+        if (nodes_[left].priority > nodes_[right].priority) {
+            nodes_[left].right = merge(nodes_[left].right, right);
+            resize(left);
+            return left;
+        }
+        nodes_[right].left = merge(left, nodes_[right].left);
+        resize(right);
+        return right;
+    }
+};
+
+class ExactQuantileEstimator : public QuantileEstimator {
+public:
+    Mode mode() const override { return Mode::Exact; }
+
+    void insert(double value) override { tree_.insert(value); }
+    void remove(double value) override { tree_.remove(value); }
+
+    double quantile(double q) const override {
+        size_t n = tree_.size();
+        if (n == 0) return 0.0;
+        if (q <= 0.0) return tree_.select(0);
+        if (q >= 1.0) return tree_.select(n - 1);
+
+        // Linear interpolation between adjacent ranks
+        double position = q * static_cast<double>(n - 1);
+        size_t index = static_cast<size_t>(position);
+        double fraction = position - static_cast<double>(index);
+        double lower = tree_.select(index);
+        if (index + 1 >= n) return lower;
+        return lower + fraction * (tree_.select(index + 1) - lower);
+    }
+
+    void assignSorted(const double* values, size_t count) override { tree_.assignSorted(values, count); }
+
+    void setWindowSize(size_t) override {}
+    void clear() override { tree_.clear(); }
+
+private:
+    OrderStatisticTree tree_;
+};
+
+// Jain & Chlamtac's P² estimator for one quantile: five markers whose heights
+// are adjusted with piecewise-parabolic interpolation as values arrive
+class P2Estimator {
+public:
+    explicit P2Estimator(double p) : p_(p) { reset(); }
+
+    void reset() {
+        count_ = 0;
+        increments_ = {0.0, p_ / 2.0, p_, (1.0 + p_) / 2.0, 1.0};
+    }
+
+    void insert(double x) {
+        if (count_ < 5) {
+            heights_[count_++] = x;
+            if (count_ == 5) {
+                std::sort(heights_.begin(), heights_.end());
+                for (int i = 0; i < 5; ++i) positions_[i] = i + 1;
+                desired_ = {1.0, 1.0 + 2.0 * p_, 1.0 + 4.0 * p_, 3.0 + 2.0 * p_, 5.0};
+            }
+            return;
+        }
+        ++count_;
+
+        int k;
+        if (x < heights_[0]) {
+            heights_[0] = x;
+            k = 0;
+        } else if (x >= heights_[4]) {
+            heights_[4] = x;
+            k = 3;
+        } else {
+            k = 0;
+            while (x >= heights_[k + 1]) ++k;
+        }
+        for (int i = k + 1; i < 5; ++i) ++positions_[i];
+        for (int i = 0; i < 5; ++i) desired_[i] += increments_[i];
+
+        for (int i = 1; i <= 3; ++i) {
+            double d = desired_[i] - positions_[i];
+            if ((d >= 1.0 && positions_[i + 1] - positions_[i] > 1) ||
+                (d <= -1.0 && positions_[i - 1] - positions_[i] < -1)) {
+                int step = d > 0.0 ? 1 : -1;
+                double candidate = parabolic(i, step);
+                if (heights_[i - 1] < candidate && candidate < heights_[i + 1]) {
+                    heights_[i] = candidate;
+                } else {
+                    heights_[i] += step * (heights_[i + step] - heights_[i]) / (positions_[i + step] - positions_[i]);
+                }
+                positions_[i] += step;
+            }
+        }
+    }
+
+    size_t count() const { return count_; }
+    double estimate() const { return count_ >= 5 ? heights_[2] : smallSample(p_); }
+    double minimum() const { return count_ >= 5 ? heights_[0] : smallSample(0.0); }
+    double maximum() const { return count_ >= 5 ? heights_[4] : smallSample(1.0); }
+
+private:
+    double p_;
+    size_t count_;
+    std::array<double, 5> heights_{};
+    std::array<int64_t, 5> positions_{};
+    std::array<double, 5> desired_{};
+    std::array<double, 5> increments_{};
+
+    double parabolic(int i, int step) const {
+        double n0 = static_cast<double>(positions_[i - 1]);
+        double n1 = static_cast<double>(positions_[i]);
+        double n2 = static_cast<double>(positions_[i + 1]);
+        return heights_[i] + step / (n2 - n0) *
+               ((n1 - n0 + step) * (heights_[i + 1] - heights_[i]) / (n2 - n1) +
+                (n2 - n1 - step) * (heights_[i] - heights_[i - 1]) / (n1 - n0));
+    }
+
+    // Fewer than five values seen: interpolate over the sorted sample
+    double smallSample(double q) const {
+        if (count_ == 0) return 0.0;
+        std::array<double, 5> sorted = heights_;
+        std::sort(sorted.begin(), sorted.begin() + count_);
+        double position = q * static_cast<double>(count_ - 1);
+        size_t index = static_cast<size_t>(position);
+        if (index + 1 >= count_) return sorted[count_ - 1];
+        return sorted[index] + (position - index) * (sorted[index + 1] - sorted[index]);
+    }
+};
+
+class ApproximateQuantileEstimator : public QuantileEstimator {
+public:
+    ApproximateQuantileEstimator(size_t windowSize, const std::vector<double>& trackedQuantiles)
+        : tracked_(trackedQuantiles) {
+        std::sort(tracked_.begin(), tracked_.end());
+        tracked_.erase(std::unique(tracked_.begin(), tracked_.end()), tracked_.end());
+        for (double q : tracked_) {
+            current_.emplace_back(q);
+            previous_.emplace_back(q);
+        }
+        setWindowSize(windowSize);
+    }
+
+    Mode mode() const override { return Mode::Approximate; }
+
+    void insert(double value) override {
+        for (auto& estimator : current_) estimator.insert(value);
+        ++currentCount_;
+
+        // Once the current generation covers half a window it replaces the previous one
+        if (currentCount_ >= generationSize_) {
+            current_.swap(previous_);
+            for (auto& estimator : current_) estimator.reset();
+            previousCount_ = currentCount_;
+            currentCount_ = 0;
+        }
+    }
+
+    void remove(double) override {}
+
+    double quantile(double q) const override {
+        const auto& generation = previousCount_ > currentCount_ ? previous_ : current_;
+        if (generation.empty() || generation.front().count() == 0) return 0.0;
+
+        // Interpolate between tracked quantiles, with the markers' min/max at the ends
+        double lowerQ = 0.0, lowerValue = generation.front().minimum();
+        for (size_t i = 0; i < tracked_.size(); ++i) {
+            double value = generation[i].estimate();
+            if (q <= tracked_[i]) {
+                double span = tracked_[i] - lowerQ;
+                return span <= 0.0 ? value : lowerValue + (q - lowerQ) / span * (value - lowerValue);
+            }
+            lowerQ = tracked_[i];
+            lowerValue = value;
+        }
+        double upperValue = generation.front().maximum();
+        double span = 1.0 - lowerQ;
+        return span <= 0.0 ? upperValue : lowerValue + (std::min(q, 1.0) - lowerQ) / span * (upperValue - lowerValue);
+    }
+
+    void setWindowSize(size_t windowSize) override {
+        generationSize_ = std::max<size_t>(windowSize / 2, 1);
+    }
+
+    void clear() override {
+        for (auto& estimator : current_) estimator.reset();
+        for (auto& estimator : previous_) estimator.reset();
+        currentCount_ = previousCount_ = 0;
+    }
+
+private:
+    std::vector<double> tracked_;
+    std::vector<P2Estimator> current_;
+    std::vector<P2Estimator> previous_;
+    size_t currentCount_ = 0;
+    size_t previousCount_ = 0;
+    size_t generationSize_ = 1;
+};
+
+} // namespace
+
+std::unique_ptr<QuantileEstimator> QuantileEstimator::create(Mode mode,
+                                                             size_t windowSize,
+                                                             const std::vector<double>& trackedQuantiles) {
+    if (mode == Mode::Approximate && !trackedQuantiles.empty()) {
+        return std::make_unique<ApproximateQuantileEstimator>(windowSize, trackedQuantiles);
+    }
+    return std::make_unique<ExactQuantileEstimator>();
+}
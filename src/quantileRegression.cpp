@@ -0,0 +1,89 @@
+#include "quantileRegression.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Residuals below this are treated as this size so their weight stays finite
+constexpr double kMinResidual = 1e-12;
+}
+
+bool QuantileRegression::fit(const std::vector<double>& features,
+                             const std::vector<double>& labels,
+                             double quantile,
+                             Coefficients& coefficients) {
+    const size_t n = labels.size();
+    if (n < kFeatures || features.size() < n * kFeatures) return false;
+    quantile = std::min(std::max(quantile, 1e-3), 1.0 - 1e-3);
+
+    // Start from ordinary least squares
+    weights_.assign(n, 1.0);
+    Coefficients beta;
+    if (!solveWeighted(features, labels, beta)) return false;
+
+    for (int iteration = 0; iteration < kMaxIterations; ++iteration) {
+        for (size_t i = 0; i < n; ++i) {
+            double residual = labels[i];
+            for (size_t j = 0; j < kFeatures; ++j) residual -= beta[j] * features[i * kFeatures + j];
+            double scale = residual >= 0.0 ? quantile : 1.0 - quantile;
+            weights_[i] = scale / std::max(std::abs(residual), kMinResidual);
+        }
+
+        Coefficients next;
+        if (!solveWeighted(features, labels, next)) break;
+
+        double change = 0.0, size = 0.0;
+        for (size_t j = 0; j < kFeatures; ++j) {
+            change = std::max(change, std::abs(next[j] - beta[j]));
+            size = std::max(size, std::abs(next[j]));
+        }
+        beta = next;
+        if (change <= 1e-9 * (1.0 + size)) break;
+    }
+
+    coefficients = beta;
+    return true;
+}
+
+bool QuantileRegression::solveWeighted(const std::vector<double>& features,
+                                       const std::vector<double>& labels,
+                                       Coefficients& coefficients) const {
+    // Normal equations (X' W X) beta = X' W y, augmented with the right-hand side
+    double a[kFeatures][kFeatures + 1] = {};
+    for (size_t i = 0; i < labels.size(); ++i) {
+        const double* x = &features[i * kFeatures];
+        double w = weights_[i];
+        for (size_t r = 0; r < kFeatures; ++r) {
+            double wx = w * x[r];
+            for (size_t c = r; c < kFeatures; ++c) a[r][c] += wx * x[c];
+            a[r][kFeatures] += wx * labels[i];
+        }
+    }
+    for (size_t r = 0; r < kFeatures; ++r) {
+        for (size_t c = 0; c < r; ++c) a[r][c] = a[c][r];
+        // Tiny ridge keeps constant or collinear features solvable
+        a[r][r] += 1e-9 * a[r][r] + 1e-18;
+    }
+
+    // Gaussian elimination with partial pivoting
+    for (size_t col = 0; col < kFeatures; ++col) {
+        size_t pivot = col;
+        for (size_t r = col + 1; r < kFeatures; ++r) {
+            if (std::abs(a[r][col]) > std::abs(a[pivot][col])) pivot = r;
+        }
+        if (std::abs(a[pivot][col]) < 1e-300) return false;
+        if (pivot != col) {
+            for (size_t c = 0; c <= kFeatures; ++c) std::swap(a[col][c], a[pivot][c]);
+        }
+        for (size_t r = col + 1; r < kFeatures; ++r) {
+            double factor = a[r][col] / a[col][col];
+            for (size_t c = col; c <= kFeatures; ++c) a[r][c] -= factor * a[col][c];
+        }
+    }
+    for (size_t r = kFeatures; r-- > 0;) {
+        double value = a[r][kFeatures];
+        for (size_t c = r + 1; c < kFeatures; ++c) value -= a[r][c] * coefficients[c];
+        coefficients[r] = value / a[r][r];
+        if (!std::isfinite(coefficients[r])) return false;
+    }
+    return true;
+}
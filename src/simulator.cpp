@@ -1,8 +1,27 @@
 #include "simulator.hpp"
+#include "threadPool.hpp"
 #include <chrono>
 #include <iomanip>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Logistic maker probability from how far the limit sits behind the mid, in
+// half spreads: below the mid for a buy, above it for a sell. A locked book
+// has no spread to scale by, so the limit either rests behind the mid, takes
+// through it, or sits at it with even odds.
+double makerProbability(OrderSide side, double limitPrice, double midPrice, double halfSpread) {
+    double passive = side == OrderSide::Buy ? midPrice - limitPrice : limitPrice - midPrice;
+    if (!(halfSpread > 0.0)) {
+        return passive > 0.0 ? 1.0 : (passive < 0.0 ? 0.0 : 0.5);
+    }
+    return 1.0 / (1.0 + std::exp(-passive / halfSpread));
+}
+
+} // namespace
 
 Simulator::Simulator()
     : slippageModel_(std::make_unique<SlippageModel>())
@@ -15,12 +34,15 @@ Simulator::Simulator()
 
 Simulator::~Simulator() = default;
 
-void Simulator::initialize(const std::string& exchange, const std::string& spotAsset) {
+void Simulator::initialize(const std::string& exchange, const std::string& spotAsset, double initialCapital) {
     exchange_ = exchange;
     spotAsset_ = spotAsset;
+    initialCapital_ = initialCapital;
+    currentCapital_ = initialCapital;
     
     feeModel_->initialize(exchange, "tier1");
     marketImpactModel_->initialize(0.02, 1000000.0);
+    slippageModel_->startFitting();
 }
 
 TradeMetrics Simulator::simulateMarketOrder(double quantityUSD) {
@@ -45,8 +67,167 @@ TradeMetrics Simulator::simulateMarketOrder(double quantityUSD) {
 
 void Simulator::updateMarketData(const OrderBook& orderbook) {
     // Use bid+ask volume as a proxy for total volume
-    double totalVolume = orderbook.getBidVolume() + orderbook.getAskVolume();
-    slippageModel_->update(orderbook.getMidPrice(), totalVolume, 0.0);
+    TopOfBook top = orderbook.getTopOfBook();
+    double totalVolume = top.bidVolume + top.askVolume;
+    slippageModel_->update(top.midPrice(), totalVolume, 0.0);
+
+    // Exchange time, or local time for books that never carried one
+    auto updateTime = orderbook.getLastUpdateTime();
+    if (updateTime.time_since_epoch().count() == 0) {
+        updateTime = std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now());
+    }
+    double timeStamp = std::chrono::duration<double>(updateTime.time_since_epoch()).count();
+
+    if (top.isTwoSided()) {
+        std::lock_guard<std::mutex> lock(estimatorMutex_);
+        marketEstimator_.update(top.midPrice(), timeStamp);
+    }
+    if (!parametersPublished_ || timeStamp - lastParameterUpdate_ >= parameterUpdateInterval_) {
+        publishMarketParameters(timeStamp);
+    }
+    // Sweeping the book for training data and checking the surface cost more
+    // than the book update itself, so they run on the same cadence
+    if (top.isTwoSided() && (!surfaceSampled_ || timeStamp - lastSurfaceSample_ >= parameterUpdateInterval_)) {
+        recordSweepObservations(orderbook.view(kSweepDepth));
+        refreshCostSurface(top.midPrice(), timeStamp);
+        lastSurfaceSample_ = timeStamp;
+        surfaceSampled_ = true;
+    }
+}
+
+CostSurface::Inputs Simulator::costSurfaceInputs(CostSurface::Part part, double midPrice) const {
+    if (part == CostSurface::Part::Row) {
+        // The slippage scale moves with almost every book update; keyed in
+        // kSlippageScaleStep steps, only a real move refreshes the row
+        double slippageScale = slippageModel_->predictSlippage(1.0, 1.0, kSlippageConfidence);
+        if (slippageScale > 0.0) {
+            const double step = std::log1p(kSlippageScaleStep);
+            slippageScale = std::exp(std::round(std::log(slippageScale) / step) * step);
+        }
+        return {midPrice, slippageScale, feeModel_->getTakerFeeRate(), 0.0};
+    }
+    // The even schedule's cost depends on neither volatility nor the impact exponent
+    MarketImpactModel::Parameters impact = marketImpactModel_->getParameters();
+    return {midPrice, impact.dailyVolume, impact.permanentImpactFactor, impact.temporaryImpactFactor};
+}
+
+// Recompute each part of the surface only once its own inputs have drifted:
+// the row (slippage + taker fees, as for a market buy) holds one cost per
+// size, the grid (schedule cost) one per size and horizon
+void Simulator::refreshCostSurface(double midPrice, double timeStamp) {
+    const auto& sizes = costSurface_.sizes();
+    const auto& horizons = costSurface_.horizons();
+
+    CostSurface::Inputs rowInputs = costSurfaceInputs(CostSurface::Part::Row, midPrice);
+    if (costSurface_.needsRefresh(CostSurface::Part::Row, rowInputs, timeStamp)) {
+        auto start = std::chrono::steady_clock::now();
+        surfaceCosts_.resize(sizes.size());
+        slippageModel_->predictSlippageBatch(sizes.data(), sizes.size(), midPrice, kSlippageConfidence,
+                                             surfaceCosts_.data());
+        const double feePerUnit = midPrice * feeModel_->getTakerFeeRate();
+        for (size_t i = 0; i < sizes.size(); ++i) surfaceCosts_[i] += sizes[i] * feePerUnit;
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        costSurface_.publish(CostSurface::Part::Row, surfaceCosts_.data(), rowInputs, timeStamp, micros);
+    }
+
+    CostSurface::Inputs gridInputs = costSurfaceInputs(CostSurface::Part::Grid, midPrice);
+    if (costSurface_.needsRefresh(CostSurface::Part::Grid, gridInputs, timeStamp)) {
+        auto start = std::chrono::steady_clock::now();
+        const size_t cells = sizes.size() * horizons.size();
+        if (surfaceSizes_.size() != cells) {
+            surfaceSizes_.resize(cells);
+            surfaceHorizons_.resize(cells);
+        }
+        for (size_t h = 0; h < horizons.size(); ++h) {
+            std::copy(sizes.begin(), sizes.end(), surfaceSizes_.begin() + h * sizes.size());
+            std::fill_n(surfaceHorizons_.begin() + h * sizes.size(), sizes.size(), horizons[h]);
+        }
+        surfaceCosts_.resize(cells);
+        marketImpactModel_->calculateScheduleCosts(surfaceSizes_.data(), surfaceHorizons_.data(), cells, midPrice,
+                                                   surfaceCosts_.data());
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        costSurface_.publish(CostSurface::Part::Grid, surfaceCosts_.data(), gridInputs, timeStamp, micros);
+    }
+}
+
+void Simulator::enableMonteCarlo(const MonteCarloEngine::Config& config, size_t threads) {
+    monteCarloConfig_ = config;
+    monteCarloPool_ = std::make_unique<ThreadPool>(threads);
+    monteCarloEnabled_ = true;
+}
+
+void Simulator::disableMonteCarlo() {
+    monteCarloEnabled_ = false;
+}
+
+CostDistribution Simulator::simulateCostDistribution(double orderSize, double timeHorizon, const BookView& view) {
+    if (!view.isTwoSided()) return CostDistribution{};
+    if (!monteCarloPool_) monteCarloPool_ = std::make_unique<ThreadPool>();
+
+    MarketImpactModel::Parameters impact = marketImpactModel_->getParameters();
+    MonteCarloEngine::Market market;
+    market.midPrice = view.midPrice;
+    market.halfSpread = view.spread / 2.0;
+    market.volatility = impact.volatility;
+    market.dailyVolume = impact.dailyVolume;
+    market.permanentImpactFactor = impact.permanentImpactFactor;
+    market.temporaryImpactFactor = impact.temporaryImpactFactor;
+    market.feeRate = feeModel_->getTakerFeeRate();
+
+    ExecutionTrajectory schedule = marketImpactModel_->calculateExecutionTrajectory(
+        orderSize, timeHorizon, monteCarloConfig_.riskAversion, monteCarloConfig_.slices, view.midPrice);
+    return MonteCarloEngine::simulate(orderSize, schedule.trades, timeHorizon, market, monteCarloConfig_,
+                                      monteCarloPool_.get());
+}
+
+double Simulator::lookupExpectedCost(double orderSize, double timeHorizon) const {
+    return costSurface_.lookup(orderSize, timeHorizon);
+}
+
+void Simulator::configureCostSurface(const CostSurface::Config& config) {
+    costSurface_.configure(config);
+}
+
+CostSurface::Stats Simulator::getCostSurfaceStats() const {
+    return costSurface_.stats();
+}
+
+void Simulator::publishMarketParameters(double timeStamp) {
+    MarketEstimates estimates = getMarketEstimates();
+    MarketImpactModel::Parameters current = marketImpactModel_->getParameters();
+
+    // Keep the previous value for anything the estimators cannot tell yet
+    double volatility = estimates.completedBars >= kMinBarsForVolatility && estimates.ewmaVolatility > 0.0
+        ? estimates.ewmaVolatility
+        : current.volatility;
+    double dailyVolume = estimates.dailyVolume > 0.0 ? estimates.dailyVolume : current.dailyVolume;
+
+    marketImpactModel_->updateMarketConditions(volatility, dailyVolume);
+    currentVolatility_ = volatility;
+    lastParameterUpdate_ = timeStamp;
+    parametersPublished_ = true;
+}
+
+void Simulator::recordTrade(double quantity, double timeStamp) {
+    std::lock_guard<std::mutex> lock(estimatorMutex_);
+    marketEstimator_.addTrade(std::abs(quantity), timeStamp);
+}
+
+void Simulator::setParameterUpdateInterval(double seconds) {
+    parameterUpdateInterval_ = std::max(seconds, 0.0);
+}
+
+double Simulator::getParameterUpdateInterval() const {
+    return parameterUpdateInterval_;
+}
+
+bool Simulator::loadImpactParameters(const std::string& filename) {
+    return marketImpactModel_->loadParameters(filename);
+}
+
+MarketEstimates Simulator::getMarketEstimates() const {
+    std::lock_guard<std::mutex> lock(estimatorMutex_);
+    return marketEstimator_.estimates();
 }
 
 double Simulator::getCurrentVolatility() const {
@@ -58,9 +239,8 @@ std::string Simulator::getCurrentFeeTier() const {
 }
 
 double Simulator::calculateMakerTakerProportion(const OrderBook& orderbook) {
-    double bidVolume = orderbook.getBidVolume();
-    double askVolume = orderbook.getAskVolume();
-    return bidVolume / (bidVolume + askVolume);
+    TopOfBook top = orderbook.getTopOfBook();
+    return top.bidVolume / (top.bidVolume + top.askVolume);
 }
 
 double Simulator::measureInternalLatency() {
@@ -124,12 +304,46 @@ double Simulator::getCurrentPnL() const {
     return currentCapital_ - initialCapital_;
 }
 
-void Simulator::saveState(const std::string& filename) {
-    // TODO: Implement state saving
+namespace {
+constexpr uint32_t kStateVersion = 1;
+constexpr char kStateMagic[9] = "QSSIMSTA";
+}
+
+bool Simulator::saveState(const std::string& filename) const {
+    StateWriter writer;
+    writer.write(initialCapital_);
+    writer.write(currentCapital_);
+    writer.write(currentPosition_);
+    writer.write(currentVolatility_);
+    writer.writeString(exchange_);
+    writer.writeString(spotAsset_);
+    writer.writeString(currentFeeTier_);
+    slippageModel_->writeState(writer);
+    return writer.save(filename, kStateMagic, kStateVersion);
 }
 
-void Simulator::loadState(const std::string& filename) {
-    // TODO: Implement state loading
+bool Simulator::loadState(const std::string& filename) {
+    StateReader reader;
+    if (!reader.open(filename, kStateMagic, kStateVersion)) return false;
+
+    double initialCapital, currentCapital, currentPosition, currentVolatility;
+    std::string exchange, spotAsset, feeTier;
+    if (!reader.read(initialCapital) || !reader.read(currentCapital) ||
+        !reader.read(currentPosition) || !reader.read(currentVolatility) ||
+        !reader.readString(exchange) || !reader.readString(spotAsset) || !reader.readString(feeTier)) {
+        return false;
+    }
+    // The model only changes if its whole section is valid
+    if (!slippageModel_->readState(reader)) return false;
+
+    initialCapital_ = initialCapital;
+    currentCapital_ = currentCapital;
+    currentPosition_ = currentPosition;
+    currentVolatility_ = currentVolatility;
+    exchange_ = exchange;
+    spotAsset_ = spotAsset;
+    currentFeeTier_ = feeTier;
+    return true;
 }
 
 DetailedTradeMetrics Simulator::calculateTradeMetrics(double orderSize,
@@ -137,23 +351,29 @@ DetailedTradeMetrics Simulator::calculateTradeMetrics(double orderSize,
                                                     const std::string& orderType,
                                                     const OrderBook& orderbook,
                                                     double timeHorizon) {
+    // One consistent snapshot feeds every metric below
+    BookView view = orderbook.view(kSweepDepth);
+    return calculateTradeMetrics(orderSize, limitPrice, orderType, view, timeHorizon);
+}
+
+DetailedTradeMetrics Simulator::calculateTradeMetrics(double orderSize,
+                                                    double limitPrice,
+                                                    const std::string& orderType,
+                                                    const BookView& view,
+                                                    double timeHorizon) {
     DetailedTradeMetrics metrics;
     
-    // Get current market conditions
-    auto bestAsk = orderbook.getBestAsk();
-    auto bestBid = orderbook.getBestBid();
-    
-    if (!bestAsk || !bestBid) {
+    if (!view.isTwoSided()) {
         return metrics;  // Return empty metrics if no market data
     }
     
     // Calculate market conditions
-    metrics.currentSpread = bestAsk->price - bestBid->price;
-    metrics.midPrice = (bestAsk->price + bestBid->price) / 2.0;
-    metrics.orderBookImbalance = calculateOrderBookImbalance(orderbook);
+    metrics.currentSpread = view.spread;
+    metrics.midPrice = view.midPrice;
+    metrics.orderBookImbalance = calculateOrderBookImbalance(view);
     
     // Calculate expected costs with confidence levels
-    metrics.slippageConfidence = 0.95;  // 95% confidence level
+    metrics.slippageConfidence = kSlippageConfidence;
     metrics.impactConfidence = 0.90;    // 90% confidence level
     
     metrics.expectedSlippage = slippageModel_->predictSlippage(
@@ -168,13 +388,17 @@ DetailedTradeMetrics Simulator::calculateTradeMetrics(double orderSize,
         timeHorizon
     );
     
-    // Calculate maker/taker probability
-    metrics.makerTakerRatio = calculateMakerTakerProbability(orderbook, limitPrice);
+    // Calculate maker/taker probability; a positive size buys, as in the sweep below
+    OrderSide side = orderSize >= 0.0 ? OrderSide::Buy : OrderSide::Sell;
+    if (orderType == "market") {
+        limitPrice = side == OrderSide::Buy ? std::numeric_limits<double>::infinity() : 0.0;
+    }
+    metrics.makerTakerRatio = calculateMakerTakerProbability(view, limitPrice, side);
     
     // Calculate fees based on maker/taker probability
     bool isMaker = (metrics.makerTakerRatio > 0.5);
     metrics.expectedFees = feeModel_->calculateFees(
-        orderSize,
+        std::abs(orderSize),   // Sells pay fees too
         metrics.midPrice,
         isMaker
     );
@@ -184,55 +408,167 @@ DetailedTradeMetrics Simulator::calculateTradeMetrics(double orderSize,
                      metrics.expectedFees + 
                      metrics.expectedMarketImpact;
     
+    // Walk the book: a positive size buys from the asks, a negative one sells into the bids
+    SweepEngine sweepEngine;
+    sweepEngine.load(orderSize >= 0.0 ? view.asks : view.bids, metrics.midPrice);
+    SweepResult sweep = sweepEngine.sweep(std::abs(orderSize));
+    metrics.sweepVwap = sweep.vwap;
+    metrics.sweepCost = sweep.cost;
+    metrics.sweepResidual = sweep.residualQuantity;
+    metrics.sweepLevelsConsumed = sweep.levelsConsumed;
+
+    // Regression trained on book sweeps in updateMarketData, next to the sweep above
+    metrics.regressionSlippage = slippageModel_->predictRegressionSlippage(
+        orderSize,
+        metrics.midPrice,
+        metrics.currentSpread / metrics.midPrice,
+        metrics.orderBookImbalance,
+        metrics.slippageConfidence
+    );
+    
+    if (monteCarloEnabled_) {
+        CostDistribution distribution = simulateCostDistribution(orderSize, timeHorizon, view);
+        if (!distribution.levels.empty()) {
+            metrics.hasCostDistribution = true;
+            metrics.costConfidence = distribution.levels.front();
+            metrics.costMean = distribution.mean;
+            metrics.costValueAtRisk = distribution.valueAtRisk.front();
+            metrics.costExpectedShortfall = distribution.expectedShortfall.front();
+        }
+    }
+    
     // Estimate internal latency
     metrics.internalLatency = estimateInternalLatency();
     
     return metrics;
 }
 
-double Simulator::calculateMakerTakerProbability(const OrderBook& orderbook, double limitPrice) {
-    auto bestAsk = orderbook.getBestAsk();
-    auto bestBid = orderbook.getBestBid();
-    
-    if (!bestAsk || !bestBid) {
-        return 0.5;  // Default to 50% if no market data
+void Simulator::calculateTradeMetricsBatch(const double* orderSizes,
+                                           const OrderSide* sides,
+                                           const double* limitPrices,
+                                           const double* timeHorizons,
+                                           size_t count,
+                                           const OrderBook& orderbook,
+                                           TradeMetricsBatch& metrics) {
+    BookView view = orderbook.view(kSweepDepth);
+    calculateTradeMetricsBatch(orderSizes, sides, limitPrices, timeHorizons, count, view, metrics);
+}
+
+void Simulator::calculateTradeMetricsBatch(const double* orderSizes,
+                                           const OrderSide* sides,
+                                           const double* limitPrices,
+                                           const double* timeHorizons,
+                                           size_t count,
+                                           const BookView& view,
+                                           TradeMetricsBatch& metrics) {
+    metrics.resize(count);
+    if (!view.isTwoSided()) {
+        for (auto* column : {&metrics.expectedSlippage, &metrics.expectedMarketImpact, &metrics.scheduleCost,
+                             &metrics.expectedFees, &metrics.makerTakerRatio, &metrics.netCost,
+                             &metrics.sweepVwap, &metrics.sweepCost, &metrics.sweepResidual}) {
+            std::fill(column->begin(), column->end(), 0.0);
+        }
+        metrics.midPrice = metrics.currentSpread = metrics.orderBookImbalance = 0.0;
+        return;
     }
-    
-    // Simple logistic regression based on price position relative to spread
-    double midPrice = (bestAsk->price + bestBid->price) / 2.0;
-    double spread = bestAsk->price - bestBid->price;
-    
-    // Calculate how far the limit price is from the mid price in terms of spread
-    double normalizedDistance = (limitPrice - midPrice) / (spread / 2.0);
-    
-    // Apply logistic function: 1 / (1 + e^(-x))
-    double probability = 1.0 / (1.0 + std::exp(-normalizedDistance));
-    
-    return probability;
+
+    const double mid = view.midPrice;
+    metrics.midPrice = mid;
+    metrics.currentSpread = view.spread;
+    metrics.orderBookImbalance = calculateOrderBookImbalance(view);
+
+    // Each model reads its parameters once for the whole batch
+    slippageModel_->predictSlippageBatch(orderSizes, count, mid, kSlippageConfidence, metrics.expectedSlippage.data());
+    marketImpactModel_->calculateMarketImpactBatch(orderSizes, count, mid, metrics.expectedMarketImpact.data());
+    marketImpactModel_->calculateScheduleCosts(orderSizes, timeHorizons, count, mid, metrics.scheduleCost.data());
+
+    const double makerRate = feeModel_->getMakerFeeRate();
+    const double takerRate = feeModel_->getTakerFeeRate();
+    const double halfSpread = view.spread / 2.0;
+    double* makerTaker = metrics.makerTakerRatio.data();
+    double* fees = metrics.expectedFees.data();
+    double* net = metrics.netCost.data();
+    const double* slippage = metrics.expectedSlippage.data();
+    const double* impact = metrics.expectedMarketImpact.data();
+    for (size_t i = 0; i < count; ++i) {
+        double probability = makerProbability(sides[i], limitPrices[i], mid, halfSpread);
+        makerTaker[i] = probability;
+        fees[i] = std::abs(orderSizes[i]) * mid * (probability > 0.5 ? makerRate : takerRate);
+        net[i] = slippage[i] + fees[i] + impact[i];
+    }
+
+    sweepBatchSide(view, OrderSide::Buy, orderSizes, sides, count, metrics);
+    sweepBatchSide(view, OrderSide::Sell, orderSizes, sides, count, metrics);
 }
 
-double Simulator::calculateOrderBookImbalance(const OrderBook& orderbook) {
-    // Get top 10 levels of the order book
-    auto asks = orderbook.getAsksAtDepth(10);
-    auto bids = orderbook.getBidsAtDepth(10);
-    
-    double totalAskVolume = 0.0;
-    double totalBidVolume = 0.0;
-    
-    for (const auto& ask : asks) {
-        totalAskVolume += ask.quantity;
+// Gather one side's orders, sweep them in one pass and scatter the results back
+void Simulator::sweepBatchSide(const BookView& view,
+                               OrderSide side,
+                               const double* orderSizes,
+                               const OrderSide* sides,
+                               size_t count,
+                               TradeMetricsBatch& metrics) {
+    if (batchIndices_.size() < count) {
+        batchIndices_.resize(count);
+        batchQuantities_.resize(count);
+        batchVwaps_.resize(count);
+        batchCosts_.resize(count);
+        batchResiduals_.resize(count);
     }
-    
-    for (const auto& bid : bids) {
-        totalBidVolume += bid.quantity;
+
+    size_t n = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (sides[i] != side) continue;
+        batchIndices_[n] = i;
+        batchQuantities_[n] = std::abs(orderSizes[i]);
+        ++n;
     }
-    
-    double totalVolume = totalAskVolume + totalBidVolume;
-    if (totalVolume == 0.0) {
-        return 0.0;
+    if (n == 0) return;
+
+    SweepEngine sweepEngine;
+    sweepEngine.load(side == OrderSide::Buy ? view.asks : view.bids, view.midPrice);
+    sweepEngine.sweepMany(batchQuantities_.data(), n, batchVwaps_.data(), batchCosts_.data(), batchResiduals_.data());
+
+    for (size_t k = 0; k < n; ++k) {
+        size_t i = batchIndices_[k];
+        metrics.sweepVwap[i] = batchVwaps_[k];
+        metrics.sweepCost[i] = batchCosts_[k];
+        metrics.sweepResidual[i] = batchResiduals_[k];
+    }
+}
+
+double Simulator::calculateMakerTakerProbability(const BookView& view, double limitPrice, OrderSide side) {
+    if (!view.isTwoSided()) {
+        return 0.5;  // Default to 50% if no market data
+    }
+    return makerProbability(side, limitPrice, view.midPrice, view.spread / 2.0);
+}
+
+double Simulator::calculateOrderBookImbalance(const BookView& view) {
+    // Top 10 levels of the order book
+    return view.imbalance(kImbalanceDepth);
+}
+
+// Sweep each side at fixed fractions of its depth, so the training set only
+// depends on the books seen, not on which orders callers price
+void Simulator::recordSweepObservations(const BookView& view) {
+    if (!view.isTwoSided() || view.midPrice <= 0.0) return;
+
+    const double relativeSpread = view.spread / view.midPrice;
+    const double imbalance = calculateOrderBookImbalance(view);
+    std::array<double, kObservationDepthFractions.size()> sizes, costs, residuals;
+    for (const BookView::Side* side : {&view.asks, &view.bids}) {
+        const double depth = side->totalQuantity(kImbalanceDepth);
+        for (size_t i = 0; i < sizes.size(); ++i) sizes[i] = depth * kObservationDepthFractions[i];
+
+        SweepEngine sweepEngine;
+        sweepEngine.load(*side, view.midPrice);
+        sweepEngine.sweepMany(sizes.data(), sizes.size(), nullptr, costs.data(), residuals.data());
+        for (size_t i = 0; i < sizes.size(); ++i) {
+            if (sizes[i] <= 0.0 || residuals[i] > 0.0) continue;
+            slippageModel_->addObservation(sizes[i], relativeSpread, imbalance, costs[i] / (sizes[i] * view.midPrice));
+        }
     }
-    
-    return (totalBidVolume - totalAskVolume) / totalVolume;
 }
 
 double Simulator::estimateInternalLatency() {
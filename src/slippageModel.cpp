@@ -1,90 +1,267 @@
 #include "slippageModel.hpp"
+#include "priceHistory.hpp"
+#include "runningStats.hpp"
+#include "seqLock.hpp"
+#include "quantileRegression.hpp"
 #include <vector>
+#include <array>
 #include <algorithm>
 #include <cmath>
-#include <numeric>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
 
 class SlippageModel::Impl {
 public:
-    struct DataPoint {
-        double price;
-        double volume;
-        double timeStamp;
+    PriceHistory historicalData_;
+    std::unique_ptr<QuantileEstimator> returnQuantiles_;  // Over consecutive returns in the window
+    RunningStats returnStats_;       // Same returns
+    RunningStats volumeStats_;       // Positive volumes in the window
+    size_t evictionsSinceRebuild_ = 0;
+    std::vector<double> quantiles_;
+    std::mutex mutex_;  // Serializes writers; predictions read the snapshot instead
+
+    // Everything a prediction needs, republished after each change to the window.
+    // Return quantiles are captured at snapshotLevels_: 0, quantiles_..., 1.
+    struct Snapshot {
+        static constexpr size_t kMaxLevels = 16;
+        double avgVolume = 0.0;
+        double meanReturn = 0.0;
+        double returnStdDev = 0.0;
+        size_t levelCount = 0;   // 0 until the window holds a return
+        std::array<double, kMaxLevels> returnQuantiles{};
     };
+    std::vector<double> snapshotLevels_;   // Fixed after construction
+    SeqLock<Snapshot> snapshot_;
 
-    std::vector<DataPoint> historicalData_;
-    std::vector<double> quantiles_;
-    double currentQuantile_;
-    std::mutex mutex_;  // love thread safety
+    // Realized slippage observations for the regression, as a ring of rows
+    static constexpr size_t kObservationWindow = 5000;
+    std::mutex observationMutex_;
+    std::vector<double> observationFeatures_;   // kObservationWindow rows of kFeatures
+    std::vector<double> observationLabels_;
+    size_t observationHead_ = 0;
+    size_t observationCount_ = 0;
+    uint64_t observationsAdded_ = 0;
+
+    // Coefficients per tracked quantile (quantiles_[i]), swapped in whole after each fit
+    struct RegressionSnapshot {
+        size_t levelCount = 0;   // 0 until the first successful fit
+        std::array<QuantileRegression::Coefficients, Snapshot::kMaxLevels> coefficients{};
+    };
+    SeqLock<RegressionSnapshot> regression_;
+    std::mutex fitRunMutex_;                   // One fit (and one regression_ writer) at a time
+    QuantileRegression solver_;
+    std::vector<double> fitFeatures_;          // Copies taken so fitting runs without observationMutex_
+    std::vector<double> fitLabels_;
+    uint64_t lastFittedObservations_ = 0;
+
+    // Background refit worker
+    std::thread fitThread_;
+    std::mutex fitMutex_;
+    std::condition_variable fitCondition_;
+    bool fitStop_ = false;
 
-    Impl() : currentQuantile_(0.95) {
+    explicit Impl(size_t windowSize) : historicalData_(windowSize) {
         // Initialize with common quantiles
         quantiles_ = {0.1, 0.25, 0.5, 0.75, 0.9, 0.95, 0.99};
+        returnQuantiles_ = QuantileEstimator::create(QuantileEstimator::Mode::Exact, windowSize, quantiles_);
+
+        snapshotLevels_.push_back(0.0);
+        snapshotLevels_.insert(snapshotLevels_.end(), quantiles_.begin(), quantiles_.end());
+        snapshotLevels_.push_back(1.0);
+
+        observationFeatures_.assign(kObservationWindow * QuantileRegression::kFeatures, 0.0);
+        observationLabels_.assign(kObservationWindow, 0.0);
     }
 
-    double predictQuantile(const std::vector<double>& values, double quantile) {
-        if (values.empty()) return 0.0;
-        if (quantile <= 0.0) return values.front();
-        if (quantile >= 1.0) return values.back();
-        
-        std::vector<double> sortedValues = values;
-        std::sort(sortedValues.begin(), sortedValues.end());
-        
-        double position = quantile * (sortedValues.size() - 1);
-        size_t index = static_cast<size_t>(position);
-        double fraction = position - index;
-        
-        if (index + 1 >= sortedValues.size()) {
-            return sortedValues[index];
+    ~Impl() { stopFitting(); }
+
+    void stopFitting() {
+        {
+            std::lock_guard<std::mutex> lock(fitMutex_);
+            fitStop_ = true;
         }
-        
-        // Linear interpolation between adjacent values
-        return sortedValues[index] + fraction * (sortedValues[index + 1] - sortedValues[index]);
+        fitCondition_.notify_all();
+        if (fitThread_.joinable()) fitThread_.join();
     }
 
-    double calculateSlippage(double orderSize, double currentPrice) {
-        if (historicalData_.empty()) return 0.0;
-        if (currentPrice <= 0.0) return 0.0;
+    void fitLoop(std::chrono::milliseconds interval) {
+        std::unique_lock<std::mutex> lock(fitMutex_);
+        while (!fitCondition_.wait_for(lock, interval, [this] { return fitStop_; })) {
+            lock.unlock();
+            fitRegression();
+            lock.lock();
+        }
+    }
 
-        // price impact based on order size relative to historical volumes
-        std::vector<double> volumes;
-        for (const auto& data : historicalData_) {
-            if (data.volume > 0.0) {  
-                volumes.push_back(data.volume);
+    // Refit every tracked quantile over the observation window and publish
+    bool fitRegression() {
+        std::lock_guard<std::mutex> fitLock(fitRunMutex_);
+        {
+            std::lock_guard<std::mutex> lock(observationMutex_);
+            if (observationsAdded_ == lastFittedObservations_) return false;  // Nothing new
+            lastFittedObservations_ = observationsAdded_;
+            fitFeatures_.assign(observationFeatures_.begin(),
+                                observationFeatures_.begin() + observationCount_ * QuantileRegression::kFeatures);
+            fitLabels_.assign(observationLabels_.begin(), observationLabels_.begin() + observationCount_);
+        }
+
+        RegressionSnapshot fitted;
+        fitted.levelCount = std::min(quantiles_.size(), Snapshot::kMaxLevels);
+        for (size_t i = 0; i < fitted.levelCount; ++i) {
+            if (!solver_.fit(fitFeatures_, fitLabels_, quantiles_[i], fitted.coefficients[i])) return false;
+        }
+        regression_.store(fitted);
+        return true;
+    }
+
+    // Regression features for an order against the current window; false if
+    // the window has no volume to scale by yet
+    static bool regressionFeatures(const Snapshot& snapshot, double orderSize, double relativeSpread,
+                                   double imbalance, QuantileRegression::Features& x) {
+        if (snapshot.avgVolume <= 0.0) return false;
+        x = {1.0, std::sqrt(std::abs(orderSize) / snapshot.avgVolume), relativeSpread, imbalance, snapshot.returnStdDev};
+        return true;
+    }
+
+    // Append a point and keep the windowed statistics in step with the history
+    void addPoint(double price, double volume, double timeStamp) {
+        double previous = historicalData_.empty() ? 0.0 : historicalData_.price(historicalData_.size() - 1);
+        PriceHistory::Point evicted;
+        bool dropped = historicalData_.push(price, volume, timeStamp, evicted);
+
+        if (previous > 0.0) {
+            addReturn((price - previous) / previous);
+        }
+        if (volume > 0.0) volumeStats_.add(volume);
+        if (!dropped) return;
+
+        // The return from the evicted point to its successor leaves the window
+        if (evicted.price > 0.0) {
+            removeReturn((historicalData_.price(0) - evicted.price) / evicted.price);
+        }
+        if (evicted.volume > 0.0) volumeStats_.remove(evicted.volume);
+
+        // Resum once per window so add/remove rounding cannot drift (amortized O(1))
+        if (++evictionsSinceRebuild_ >= historicalData_.capacity()) {
+            rebuildStats();
+        }
+    }
+
+    void addReturn(double ret) {
+        returnQuantiles_->insert(ret);
+        returnStats_.add(ret);
+    }
+
+    void removeReturn(double ret) {
+        returnQuantiles_->remove(ret);
+        returnStats_.remove(ret);
+    }
+
+    void rebuildStats() {
+        returnStats_.clear();
+        volumeStats_.clear();
+        for (size_t i = 0; i < historicalData_.size(); ++i) {
+            if (historicalData_.volume(i) > 0.0) volumeStats_.add(historicalData_.volume(i));
+            if (i == 0) continue;
+            double previous = historicalData_.price(i - 1);
+            if (previous > 0.0) returnStats_.add((historicalData_.price(i) - previous) / previous);
+        }
+        evictionsSinceRebuild_ = 0;
+    }
+
+    void rebuildReturns() {
+        returnQuantiles_->clear();
+        returnQuantiles_->setWindowSize(historicalData_.capacity());
+        for (size_t i = 1; i < historicalData_.size(); ++i) {
+            double previous = historicalData_.price(i - 1);
+            if (previous > 0.0) {
+                returnQuantiles_->insert((historicalData_.price(i) - previous) / previous);
             }
         }
-        
-        if (volumes.empty()) return 0.0;
-        
-        double avgVolume = std::accumulate(volumes.begin(), volumes.end(), 0.0) / volumes.size();
-        if (avgVolume <= 0.0) return 0.0;
-        
-        double sizeRatio = std::abs(orderSize) / avgVolume;
-        
-        // price volatility
-        std::vector<double> returns;
+        rebuildStats();
+    }
+
+    // Windowed returns, oldest first
+    void collectReturns(std::vector<double>& returns) const {
+        returns.clear();
         for (size_t i = 1; i < historicalData_.size(); ++i) {
-            if (historicalData_[i-1].price > 0.0) { 
-                double ret = (historicalData_[i].price - historicalData_[i-1].price) / historicalData_[i-1].price;
-                returns.push_back(ret);
+            double previous = historicalData_.price(i - 1);
+            if (previous > 0.0) returns.push_back((historicalData_.price(i) - previous) / previous);
+        }
+    }
+
+    // State format, see SlippageModel::writeState
+    static constexpr uint32_t kStateVersion = 1;
+    static constexpr char kStateMagic[9] = "QSSLIPPG";
+
+    // Called by writers with the mutex held
+    void publish() {
+        Snapshot snapshot;
+        snapshot.avgVolume = volumeStats_.count() > 0 ? volumeStats_.mean() : 0.0;
+        snapshot.meanReturn = returnStats_.mean();
+        snapshot.returnStdDev = returnStats_.stdDev();
+        if (returnStats_.count() > 0) {
+            snapshot.levelCount = snapshotLevels_.size();
+            for (size_t i = 0; i < snapshot.levelCount; ++i) {
+                snapshot.returnQuantiles[i] = returnQuantiles_->quantile(snapshotLevels_[i]);
             }
         }
-        
-        if (returns.empty()) return 0.0;
-        
-        double volatility = predictQuantile(returns, currentQuantile_);
-        
-        // slippage as a function of size ratio and volatility
-        double slippage = currentPrice * volatility * std::sqrt(sizeRatio);
-        
-        return slippage;
+        snapshot_.store(snapshot);
+    }
+
+    // Return quantile at q, interpolated between the captured levels
+    double returnQuantile(const Snapshot& snapshot, double q) const {
+        q = std::min(std::max(q, 0.0), 1.0);
+        size_t i = 1;
+        while (i + 1 < snapshot.levelCount && snapshotLevels_[i] < q) ++i;
+        double lowerLevel = snapshotLevels_[i - 1];
+        double upperLevel = snapshotLevels_[i];
+        double lower = snapshot.returnQuantiles[i - 1];
+        double upper = snapshot.returnQuantiles[i];
+        if (q >= upperLevel) return upper;
+        return lower + (q - lowerLevel) / (upperLevel - lowerLevel) * (upper - lower);
+    }
+
+    // Size factor of the slippage formula, 0 if the snapshot cannot price the order
+    static double sizeFactor(const Snapshot& snapshot, double orderSize, double currentPrice) {
+        if (snapshot.levelCount == 0 || snapshot.avgVolume <= 0.0 || currentPrice <= 0.0) return 0.0;
+        // price impact based on order size relative to historical volumes
+        double sizeRatio = std::abs(orderSize) / snapshot.avgVolume;
+        return currentPrice * std::sqrt(sizeRatio);
     }
 };
 
-SlippageModel::SlippageModel() : pImpl(std::make_unique<Impl>()) {}
+SlippageModel::SlippageModel(size_t windowSize)
+    : pImpl(std::make_unique<Impl>(std::min(windowSize, kMaxWindowSize))) {}
 SlippageModel::~SlippageModel() = default;
 
+bool SlippageModel::setWindowSize(size_t windowSize) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->historicalData_.setCapacity(std::min(windowSize, kMaxWindowSize));
+    pImpl->rebuildReturns();
+    pImpl->publish();
+    return windowSize <= kMaxWindowSize;
+}
+
+size_t SlippageModel::getWindowSize() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->historicalData_.capacity();
+}
+
+void SlippageModel::setQuantileMode(QuantileEstimator::Mode mode) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    if (pImpl->returnQuantiles_->mode() == mode) return;
+    pImpl->returnQuantiles_ = QuantileEstimator::create(mode, pImpl->historicalData_.capacity(), pImpl->quantiles_);
+    pImpl->rebuildReturns();
+    pImpl->publish();
+}
+
+QuantileEstimator::Mode SlippageModel::getQuantileMode() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->returnQuantiles_->mode();
+}
+
 void SlippageModel::initialize(const std::vector<double>& prices,
                              const std::vector<double>& volumes,
                              const std::vector<double>& timeStamps) {
@@ -94,36 +271,246 @@ void SlippageModel::initialize(const std::vector<double>& prices,
 
     std::lock_guard<std::mutex> lock(pImpl->mutex_);
     pImpl->historicalData_.clear();
-    for (size_t i = 0; i < prices.size(); ++i) {
-        pImpl->historicalData_.push_back({prices[i], volumes[i], timeStamps[i]});
+    // Only the newest points fit in the window
+    size_t first = prices.size() - std::min(prices.size(), pImpl->historicalData_.capacity());
+    for (size_t i = first; i < prices.size(); ++i) {
+        pImpl->historicalData_.push(prices[i], volumes[i], timeStamps[i]);
     }
+    pImpl->rebuildReturns();
+    pImpl->publish();
 }
 
-double SlippageModel::predictSlippage(double orderSize, double currentPrice, double confidenceLevel) {
-    std::lock_guard<std::mutex> lock(pImpl->mutex_);
-    pImpl->currentQuantile_ = confidenceLevel;
-    return pImpl->calculateSlippage(orderSize, currentPrice);
+double SlippageModel::predictSlippage(double orderSize, double currentPrice, double confidenceLevel) const {
+    // Lock-free: one consistent snapshot, no shared state written
+    Impl::Snapshot snapshot = pImpl->snapshot_.load();
+    double factor = Impl::sizeFactor(snapshot, orderSize, currentPrice);
+    if (factor == 0.0) return 0.0;
+
+    // slippage as a function of size ratio and volatility
+    return factor * pImpl->returnQuantile(snapshot, confidenceLevel);
+}
+
+void SlippageModel::predictSlippageBatch(const double* orderSizes,
+                                         size_t count,
+                                         double currentPrice,
+                                         double quantile,
+                                         double* slippages) const {
+    Impl::Snapshot snapshot = pImpl->snapshot_.load();
+    if (Impl::sizeFactor(snapshot, 1.0, currentPrice) == 0.0) {
+        std::fill(slippages, slippages + count, 0.0);
+        return;
+    }
+
+    // Everything but the size is shared, leaving a loop the compiler vectorizes
+    double scale = currentPrice * pImpl->returnQuantile(snapshot, quantile) / std::sqrt(snapshot.avgVolume);
+    for (size_t i = 0; i < count; ++i) {
+        slippages[i] = scale * std::sqrt(std::abs(orderSizes[i]));
+    }
+}
+
+const std::vector<double>& SlippageModel::getQuantileLevels() const {
+    return pImpl->quantiles_;
+}
+
+void SlippageModel::predictSlippageDistribution(double orderSize, double currentPrice, double* slippages) const {
+    Impl::Snapshot snapshot = pImpl->snapshot_.load();
+    double factor = Impl::sizeFactor(snapshot, orderSize, currentPrice);
+
+    // quantiles_ sit at snapshot levels 1..n, so each one is read directly
+    for (size_t i = 0; i < pImpl->quantiles_.size(); ++i) {
+        slippages[i] = factor == 0.0 ? 0.0 : factor * snapshot.returnQuantiles[i + 1];
+    }
 }
 
 void SlippageModel::update(double price, double volume, double timeStamp) {
     if (price <= 0.0 || volume < 0.0) return; 
     
     std::lock_guard<std::mutex> lock(pImpl->mutex_);
-    pImpl->historicalData_.push_back({price, volume, timeStamp});
-    
-    const size_t maxDataPoints = 1000;
-    if (pImpl->historicalData_.size() > maxDataPoints) {
-        pImpl->historicalData_.erase(pImpl->historicalData_.begin(),
-                                   pImpl->historicalData_.begin() + (pImpl->historicalData_.size() - maxDataPoints));
+    pImpl->addPoint(price, volume, timeStamp);  // Overwrites the oldest point once full
+    pImpl->publish();
+}
+
+void SlippageModel::addObservation(double orderSize, double relativeSpread, double imbalance, double realizedSlippage) {
+    QuantileRegression::Features x;
+    if (!std::isfinite(realizedSlippage) ||
+        !Impl::regressionFeatures(pImpl->snapshot_.load(), orderSize, relativeSpread, imbalance, x)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->observationMutex_);
+    size_t row = pImpl->observationHead_;
+    std::copy(x.begin(), x.end(), pImpl->observationFeatures_.begin() + row * QuantileRegression::kFeatures);
+    pImpl->observationLabels_[row] = realizedSlippage;
+    pImpl->observationHead_ = (row + 1) % Impl::kObservationWindow;
+    pImpl->observationCount_ = std::min(pImpl->observationCount_ + 1, Impl::kObservationWindow);
+    ++pImpl->observationsAdded_;
+}
+
+void SlippageModel::startFitting(std::chrono::milliseconds interval) {
+    stopFitting();
+    pImpl->fitStop_ = false;
+    pImpl->fitThread_ = std::thread(&Impl::fitLoop, pImpl.get(), interval);
+}
+
+void SlippageModel::stopFitting() {
+    pImpl->stopFitting();
+}
+
+bool SlippageModel::fitRegression() {
+    return pImpl->fitRegression();
+}
+
+bool SlippageModel::isRegressionFitted() const {
+    return pImpl->regression_.load().levelCount > 0;
+}
+
+double SlippageModel::predictRegressionSlippage(double orderSize, double currentPrice, double relativeSpread,
+                                                double imbalance, double quantile) const {
+    // Lock-free: two snapshot reads and at most two dot products
+    Impl::RegressionSnapshot regression = pImpl->regression_.load();
+    QuantileRegression::Features x;
+    if (regression.levelCount == 0 || currentPrice <= 0.0 ||
+        !Impl::regressionFeatures(pImpl->snapshot_.load(), orderSize, relativeSpread, imbalance, x)) {
+        return 0.0;
+    }
+
+    // Interpolate between the fits at the neighbouring tracked quantiles
+    const auto& levels = pImpl->quantiles_;
+    size_t upper = 0;
+    while (upper + 1 < regression.levelCount && levels[upper] < quantile) ++upper;
+    double value = QuantileRegression::predict(regression.coefficients[upper], x);
+    if (upper > 0 && quantile < levels[upper]) {
+        double lowerValue = QuantileRegression::predict(regression.coefficients[upper - 1], x);
+        double t = (quantile - levels[upper - 1]) / (levels[upper] - levels[upper - 1]);
+        value = lowerValue + t * (value - lowerValue);
     }
+    return currentPrice * value;
 }
 
-// In the future can save and load model data to files here
+double SlippageModel::getMeanSlippage() const {
+    // Mean of the windowed returns (O(1), lock-free)
+    return pImpl->snapshot_.load().meanReturn;
+}
+
+double SlippageModel::getSlippageStdDev() const {
+    // Sample standard deviation of the windowed returns (O(1), lock-free)
+    return pImpl->snapshot_.load().returnStdDev;
+}
+
+double SlippageModel::getSlippageQuantile(double quantile) const {
+    // Quantile of the windowed returns, the volatility input of predictSlippage
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->returnQuantiles_->quantile(quantile);
+}
+
+void SlippageModel::writeState(StateWriter& writer) const {
+    // Layout: capacity, count, mode | prices, volumes, timestamps (oldest first)
+    //         | sorted returns (exact mode only) | regression levels, coefficients
+    std::vector<double> returns;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex_);
+        const PriceHistory& history = pImpl->historicalData_;
+        writer.write(static_cast<uint64_t>(history.capacity()));
+        writer.write(static_cast<uint64_t>(history.size()));
+        writer.write(static_cast<uint64_t>(pImpl->returnQuantiles_->mode()));
+        std::vector<double> column(history.size());
+        for (size_t i = 0; i < column.size(); ++i) column[i] = history.price(i);
+        writer.writeArray(column.data(), column.size());
+        for (size_t i = 0; i < column.size(); ++i) column[i] = history.volume(i);
+        writer.writeArray(column.data(), column.size());
+        for (size_t i = 0; i < column.size(); ++i) column[i] = history.timeStamp(i);
+        writer.writeArray(column.data(), column.size());
+        if (pImpl->returnQuantiles_->mode() == QuantileEstimator::Mode::Exact) {
+            pImpl->collectReturns(returns);
+        }
+    }
+
+    // Sorted outside the lock; lets a load rebuild the exact tree in linear time
+    std::sort(returns.begin(), returns.end());
+    writer.write(static_cast<uint64_t>(returns.size()));
+    writer.writeArray(returns.data(), returns.size());
+
+    Impl::RegressionSnapshot regression = pImpl->regression_.load();
+    writer.write(static_cast<uint64_t>(regression.levelCount));
+    for (size_t i = 0; i < regression.levelCount; ++i) {
+        writer.writeArray(regression.coefficients[i].data(), QuantileRegression::kFeatures);
+    }
+}
+
+bool SlippageModel::readState(StateReader& reader) {
+    uint64_t capacity, count, mode, sortedCount, levelCount;
+    if (!reader.read(capacity) || !reader.read(count) || !reader.read(mode)) return false;
+    // A checksum only proves the file is intact, not that its sizes are sane
+    if (capacity == 0 || capacity > kMaxWindowSize || count > capacity ||
+        mode > static_cast<uint64_t>(QuantileEstimator::Mode::Approximate)) {
+        return false;
+    }
 
-void SlippageModel::saveModel(const std::string& filename) {
-    // TODO: Implement model saving
+    // Arrays are used in place from the mapping, then copied once into the window
+    const double* prices = reader.readArray(count);
+    const double* volumes = reader.readArray(count);
+    const double* timeStamps = reader.readArray(count);
+    if (!prices || !volumes || !timeStamps || !reader.read(sortedCount)) return false;
+    const double* sortedReturns = reader.readArray(sortedCount);
+    // A fit covers every tracked quantile or none; predictRegressionSlippage
+    // indexes quantiles_ by coefficient level
+    if (!sortedReturns || !reader.read(levelCount) ||
+        (levelCount != 0 && levelCount != pImpl->quantiles_.size())) {
+        return false;
+    }
+
+    Impl::RegressionSnapshot regression;
+    regression.levelCount = levelCount;
+    for (size_t i = 0; i < levelCount; ++i) {
+        const double* coefficients = reader.readArray(QuantileRegression::kFeatures);
+        if (!coefficients) return false;
+        std::copy(coefficients, coefficients + QuantileRegression::kFeatures, regression.coefficients[i].begin());
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    PriceHistory& history = pImpl->historicalData_;
+    history.clear();
+    history.setCapacity(static_cast<size_t>(capacity));
+    history.assign(prices, volumes, timeStamps, static_cast<size_t>(count));
+
+    auto quantileMode = static_cast<QuantileEstimator::Mode>(mode);
+    pImpl->returnQuantiles_ = QuantileEstimator::create(quantileMode, history.capacity(), pImpl->quantiles_);
+
+    size_t expectedReturns = 0;
+    for (size_t i = 1; i < history.size(); ++i) {
+        if (history.price(i - 1) > 0.0) ++expectedReturns;
+    }
+    if (quantileMode == QuantileEstimator::Mode::Exact && sortedCount == expectedReturns) {
+        pImpl->returnQuantiles_->assignSorted(sortedReturns, static_cast<size_t>(sortedCount));
+        pImpl->rebuildStats();
+    } else {
+        pImpl->rebuildReturns();
+    }
+    pImpl->publish();
+
+    // Observations taken before the load describe another window; drop them
+    // with the history so the refit cadence restarts from the loaded fit
+    {
+        std::lock_guard<std::mutex> fitLock(pImpl->fitRunMutex_);
+        {
+            std::lock_guard<std::mutex> observationLock(pImpl->observationMutex_);
+            pImpl->observationHead_ = 0;
+            pImpl->observationCount_ = 0;
+            pImpl->observationsAdded_ = 0;
+            pImpl->lastFittedObservations_ = 0;
+        }
+        pImpl->regression_.store(regression);
+    }
+    return true;
 }
 
-void SlippageModel::loadModel(const std::string& filename) {
-    // TODO: Implement model loading
-} 
\ No newline at end of file
+bool SlippageModel::saveModel(const std::string& filename) const {
+    StateWriter writer;
+    writeState(writer);
+    return writer.save(filename, Impl::kStateMagic, Impl::kStateVersion);
+}
+
+bool SlippageModel::loadModel(const std::string& filename) {
+    StateReader reader;
+    return reader.open(filename, Impl::kStateMagic, Impl::kStateVersion) && readState(reader);
+}
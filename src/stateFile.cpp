@@ -0,0 +1,142 @@
+#include "stateFile.hpp"
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+namespace {
+
+constexpr size_t kAlignment = 8;
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+
+uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t mixRound(uint64_t accumulator, uint64_t word) {
+    return rotateLeft(accumulator + word * kPrime2, 31) * kPrime1;
+}
+
+uint64_t loadWord(const unsigned char* data) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+size_t padded(size_t size) {
+    return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+} // namespace
+
+uint64_t stateChecksum(const unsigned char* data, size_t size) {
+    uint64_t lanes[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+    size_t offset = 0;
+
+    // Four words per step into independent lanes, so the loop is not one long dependency chain
+    for (; offset + 32 <= size; offset += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            lanes[lane] = mixRound(lanes[lane], loadWord(data + offset + lane * 8));
+        }
+    }
+
+    uint64_t hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) +
+                    rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+    hash += static_cast<uint64_t>(size);
+    for (; offset + 8 <= size; offset += 8) {
+        hash = rotateLeft(hash ^ mixRound(0, loadWord(data + offset)), 27) * kPrime1 + kPrime3;
+    }
+    for (; offset < size; ++offset) {
+        hash = rotateLeft(hash ^ (data[offset] * kPrime3), 11) * kPrime1;
+    }
+
+    // Final avalanche
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+void StateWriter::append(const void* data, size_t size) {
+    size_t offset = payload_.size();
+    payload_.resize(offset + padded(size), 0);
+    if (size > 0) std::memcpy(payload_.data() + offset, data, size);
+}
+
+void StateWriter::writeString(const std::string& value) {
+    write(static_cast<uint64_t>(value.size()));
+    append(value.data(), value.size());
+}
+
+bool StateWriter::save(const std::string& path, const char (&magic)[9], uint32_t version) const {
+    StateFileHeader header{};
+    std::memcpy(header.magic, magic, sizeof(header.magic));
+    header.version = version;
+    header.headerSize = sizeof(StateFileHeader);
+    header.payloadSize = payload_.size();
+    header.checksum = stateChecksum(payload_.data(), payload_.size());
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(payload_.data()), static_cast<std::streamsize>(payload_.size()));
+        if (!out.flush()) return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+bool StateReader::open(const std::string& path, const char (&magic)[9], uint32_t version) {
+    offset_ = 0;
+    if (!file_.open(path)) return false;
+
+    StateFileHeader header;
+    if (file_.size() < sizeof(header)) return false;
+    std::memcpy(&header, file_.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, magic, sizeof(header.magic)) != 0 ||
+        header.version != version ||
+        header.headerSize != sizeof(StateFileHeader) ||
+        header.payloadSize != file_.size() - sizeof(header) ||
+        header.checksum != stateChecksum(file_.data() + sizeof(header), header.payloadSize)) {
+        file_.close();
+        return false;
+    }
+
+    offset_ = sizeof(header);
+    return true;
+}
+
+const unsigned char* StateReader::take(size_t size) {
+    size_t length = padded(size);
+    if (length < size || offset_ > file_.size() || file_.size() - offset_ < length) return nullptr;
+    const unsigned char* data = file_.data() + offset_;
+    offset_ += length;
+    return data;
+}
+
+bool StateReader::readString(std::string& value) {
+    uint64_t size;
+    if (!read(size) || size > file_.size()) return false;
+    const unsigned char* data = take(static_cast<size_t>(size));
+    if (!data) return false;
+    value.assign(reinterpret_cast<const char*>(data), static_cast<size_t>(size));
+    return true;
+}
+
+const double* StateReader::readArray(size_t count) {
+    if (count > std::numeric_limits<size_t>::max() / sizeof(double)) return nullptr;
+    return reinterpret_cast<const double*>(take(count * sizeof(double)));
+}
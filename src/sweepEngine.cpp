@@ -0,0 +1,85 @@
+#include "sweepEngine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void SweepEngine::load(const BookView::Side& side, double referencePrice) {
+    depth_ = side.depth;
+    referencePrice_ = referencePrice;
+
+    double quantity = 0.0;
+    double notional = 0.0;
+    for (size_t i = 0; i < depth_; ++i) {
+        prices_[i] = side.prices[i];
+        quantities_[i] = side.quantities[i];
+        quantity += side.quantities[i];
+        notional += side.prices[i] * side.quantities[i];
+        cumulativeQuantities_[i] = quantity;
+        cumulativeNotionals_[i] = notional;
+    }
+}
+
+size_t SweepEngine::lastLevel(double quantity) const {
+    const double* begin = cumulativeQuantities_.data();
+    return static_cast<size_t>(std::lower_bound(begin, begin + depth_, quantity) - begin);
+}
+
+void SweepEngine::fill(double quantity, double& filled, double& notional, size_t& levels) const {
+    if (depth_ == 0 || quantity <= 0.0) {
+        filled = notional = 0.0;
+        levels = 0;
+        return;
+    }
+
+    size_t last = lastLevel(quantity);
+    if (last == depth_) {
+        // Not enough captured depth: everything is taken, the rest is residual
+        filled = cumulativeQuantities_[depth_ - 1];
+        notional = cumulativeNotionals_[depth_ - 1];
+        levels = depth_;
+        return;
+    }
+
+    // Whole levels before `last`, then part of it
+    double before = last > 0 ? cumulativeQuantities_[last - 1] : 0.0;
+    double notionalBefore = last > 0 ? cumulativeNotionals_[last - 1] : 0.0;
+    filled = quantity;
+    notional = notionalBefore + (quantity - before) * prices_[last];
+    levels = last + 1;
+}
+
+SweepResult SweepEngine::sweep(double quantity) const {
+    SweepResult result;
+    result.requestedQuantity = quantity;
+    fill(quantity, result.filledQuantity, result.notional, result.levelsConsumed);
+    result.residualQuantity = std::max(quantity - result.filledQuantity, 0.0);
+    if (result.levelsConsumed == 0) return result;
+
+    result.vwap = result.notional / result.filledQuantity;
+    result.worstPrice = prices_[result.levelsConsumed - 1];
+
+    double remaining = result.filledQuantity;
+    for (size_t i = 0; i < result.levelsConsumed; ++i) {
+        double taken = std::min(quantities_[i], remaining);
+        remaining -= taken;
+        result.levelQuantities[i] = taken;
+        result.levelCosts[i] = std::abs(prices_[i] - referencePrice_) * taken;
+        result.cost += result.levelCosts[i];
+    }
+    return result;
+}
+
+void SweepEngine::sweepMany(const double* quantities, size_t count,
+                            double* vwaps, double* costs, double* residuals) const {
+    for (size_t i = 0; i < count; ++i) {
+        double filled, notional;
+        size_t levels;
+        fill(quantities[i], filled, notional, levels);
+
+        // The side lies entirely on one side of the reference, so the summed
+        // per-level cost collapses to one difference
+        if (vwaps) vwaps[i] = levels == 0 ? std::numeric_limits<double>::quiet_NaN() : notional / filled;
+        if (costs) costs[i] = std::abs(notional - referencePrice_ * filled);
+        if (residuals) residuals[i] = std::max(quantities[i] - filled, 0.0);
+    }
+}
@@ -0,0 +1,74 @@
+#include "threadPool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    // The caller of parallelFor is one of the threads
+    for (size_t i = 1; i < threads; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    available_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            available_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;  // Stopping and drained
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::run(const std::function<void()>& body, size_t count) {
+    if (count == 0) return;
+    size_t helpers = std::min(workers_.size(), count - 1);
+
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    size_t pending = helpers;
+    std::exception_ptr error;
+
+    auto guarded = [&]() {
+        try {
+            body();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (!error) error = std::current_exception();
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < helpers; ++i) {
+            tasks_.push([&]() {
+                guarded();
+                std::lock_guard<std::mutex> doneLock(doneMutex);
+                if (--pending == 0) doneCondition.notify_one();
+            });
+        }
+    }
+    available_.notify_all();
+
+    guarded();
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCondition.wait(lock, [&] { return pending == 0; });
+    if (error) std::rethrow_exception(error);
+}
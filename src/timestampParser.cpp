@@ -0,0 +1,93 @@
+#include "timestampParser.hpp"
+#include <cstring>
+
+namespace {
+
+bool readDigits(std::string_view text, size_t pos, size_t count, int64_t& value) {
+    value = 0;
+    for (size_t i = pos; i < pos + count; ++i) {
+        unsigned digit = static_cast<unsigned>(text[i] - '0');
+        if (digit > 9) return false;
+        value = value * 10 + digit;
+    }
+    return true;
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant's days_from_civil)
+int64_t daysFromCivil(int64_t year, int64_t month, int64_t day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const int64_t yearOfEra = year - era * 400;
+    const int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+} // namespace
+
+TimestampParser::TimestampParser() : cachedDays_(0) {
+    std::memset(cachedDate_, 0, sizeof(cachedDate_));
+}
+
+bool TimestampParser::parse(std::string_view text, Timestamp& result) {
+    if (text.size() >= 20 && text[4] == '-') {
+        return parseIso8601(text, result);
+    }
+    return parseEpochMillis(text, result);
+}
+
+bool TimestampParser::parseIso8601(std::string_view text, Timestamp& result) {
+    // YYYY-MM-DDTHH:MM:SS then optional fraction, then Z
+    if (text[7] != '-' || (text[10] != 'T' && text[10] != ' ') ||
+        text[13] != ':' || text[16] != ':' || text.back() != 'Z') {
+        return false;
+    }
+
+    int64_t days = cachedDays_;
+    if (std::memcmp(text.data(), cachedDate_, sizeof(cachedDate_)) != 0) {
+        int64_t year, month, day;
+        if (!readDigits(text, 0, 4, year) || !readDigits(text, 5, 2, month) || !readDigits(text, 8, 2, day) ||
+            month < 1 || month > 12 || day < 1 || day > 31) {
+            return false;
+        }
+        days = daysFromCivil(year, month, day);
+        std::memcpy(cachedDate_, text.data(), sizeof(cachedDate_));
+        cachedDays_ = days;
+    }
+
+    int64_t hours, minutes, seconds;
+    if (!readDigits(text, 11, 2, hours) || !readDigits(text, 14, 2, minutes) || !readDigits(text, 17, 2, seconds) ||
+        hours > 23 || minutes > 59 || seconds > 60) {
+        return false;
+    }
+
+    // Fractional seconds: any number of digits, kept to nanosecond resolution
+    int64_t nanos = 0;
+    size_t pos = 19;
+    const size_t end = text.size() - 1;  // Position of the Z
+    if (pos < end) {
+        if (text[pos] != '.') return false;
+        int64_t scale = 100000000;
+        for (++pos; pos < end; ++pos) {
+            unsigned digit = static_cast<unsigned>(text[pos] - '0');
+            if (digit > 9) return false;
+            nanos += digit * scale;
+            scale /= 10;
+        }
+    }
+
+    const int64_t totalSeconds = days * 86400 + hours * 3600 + minutes * 60 + seconds;
+    result = Timestamp(std::chrono::seconds(totalSeconds) + std::chrono::nanoseconds(nanos));
+    return true;
+}
+
+bool TimestampParser::parseEpochMillis(std::string_view text, Timestamp& result) {
+    // 13 digits covers every date up to the year 2286
+    if (text.empty() || text.size() > 15) return false;
+
+    int64_t millis;
+    if (!readDigits(text, 0, text.size(), millis)) return false;
+
+    result = Timestamp(std::chrono::milliseconds(millis));
+    return true;
+}
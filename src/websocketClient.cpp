@@ -1,7 +1,9 @@
 #include "websocketClient.hpp"
+#include <algorithm>
 #include <iostream>
+#include <chrono>
 
-WebSocketClient::WebSocketClient() : isConnected_(false), shouldStop_(false) {
+WebSocketClient::WebSocketClient() {
     // Set up SSL context
     ctx_.set_verify_mode(ssl::verify_none);
 }
@@ -43,6 +45,10 @@ void WebSocketClient::connect(const std::string& host, const std::string& port,
 
         // Start the read loop in a separate thread
         shouldStop_ = false;
+        if (ring_) {
+            computeStop_ = false;
+            compute_thread_ = std::thread([this]() { computeLoop(); });
+        }
         io_thread_ = std::thread([this]() { readLoop(); });
 
     } catch (const beast::system_error& se) {
@@ -62,6 +68,31 @@ void WebSocketClient::setConnectionHandler(ConnectionHandler handler) {
     connectionHandler_ = std::move(handler);
 }
 
+void WebSocketClient::setDrainHandler(DrainHandler handler, size_t maxFrames, std::chrono::microseconds maxDelay) {
+    drainHandler_ = std::move(handler);
+    drainMaxFrames_ = std::max<size_t>(maxFrames, 1);
+    drainMaxDelay_ = maxDelay;
+}
+
+void WebSocketClient::enablePipeline(size_t capacity, size_t reserveBytes) {
+    ring_ = std::make_unique<SpscRingBuffer<std::string>>(capacity);
+    for (size_t i = 0; i < ring_->capacity(); ++i) {
+        ring_->slot(i).reserve(reserveBytes);
+    }
+}
+
+WebSocketClient::PipelineStats WebSocketClient::getPipelineStats() const {
+    PipelineStats stats;
+    if (ring_) {
+        stats.capacity = ring_->capacity();
+        stats.queueDepth = ring_->size();
+        stats.highWatermark = highWatermark_.load(std::memory_order_relaxed);
+        stats.enqueued = enqueued_.load(std::memory_order_relaxed);
+        stats.producerStalls = producerStalls_.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
 void WebSocketClient::close() {
     if (isConnected_) {
         shouldStop_ = true;
@@ -72,22 +103,36 @@ void WebSocketClient::close() {
                 std::cerr << "Error closing connection: " << e.what() << std::endl;
             }
         }
-        if (io_thread_.joinable()) {
-            io_thread_.join();
-        }
         isConnected_ = false;
     }
+    if (io_thread_.joinable()) {
+        io_thread_.join();
+    }
+
+    // The compute thread drains whatever the I/O thread queued before stopping
+    computeStop_ = true;
+    if (compute_thread_.joinable()) {
+        compute_thread_.join();
+    }
 }
 
 void WebSocketClient::readLoop() {
     try {
+        beast::flat_buffer buffer;
         while (!shouldStop_ && isConnected_) {
-            beast::flat_buffer buffer;
+            buffer.consume(buffer.size());
             ws_->read(buffer);
             
-            if (messageHandler_) {
-                std::string message = beast::buffers_to_string(buffer.data());
-                messageHandler_(message);
+            if (ring_) {
+                if (!enqueue(buffer)) break;
+            } else {
+                if (messageHandler_) {
+                    std::string message = beast::buffers_to_string(buffer.data());
+                    messageHandler_(message);
+                }
+                if (drainHandler_) {
+                    drainHandler_();
+                }
             }
         }
     } catch (const beast::system_error& se) {
@@ -100,6 +145,68 @@ void WebSocketClient::readLoop() {
     isConnected_ = false;
 }
 
+bool WebSocketClient::enqueue(const beast::flat_buffer& buffer) {
+    std::string* slot = ring_->beginPush();
+    if (!slot) {
+        // Back-pressure rather than drop: book deltas cannot be skipped
+        producerStalls_.fetch_add(1, std::memory_order_relaxed);
+        while (!(slot = ring_->beginPush())) {
+            if (shouldStop_) return false;
+            std::this_thread::yield();
+        }
+    }
+
+    auto data = buffer.data();
+    slot->assign(static_cast<const char*>(data.data()), data.size());
+    ring_->commitPush();
+    enqueued_.fetch_add(1, std::memory_order_relaxed);
+
+    size_t depth = ring_->size();
+    if (depth > highWatermark_.load(std::memory_order_relaxed)) {
+        highWatermark_.store(depth, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void WebSocketClient::computeLoop() {
+    unsigned idleSpins = 0;
+    size_t framesSinceDrain = 0;
+    auto lastDrain = std::chrono::steady_clock::now();
+    while (true) {
+        std::string* message = ring_->front();
+        if (!message) {
+            if (computeStop_) break;
+            // Spin briefly for low latency, then stop burning the core
+            if (++idleSpins < 1000) continue;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            continue;
+        }
+        idleSpins = 0;
+
+        try {
+            if (messageHandler_) {
+                messageHandler_(*message);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error in compute loop: " << e.what() << std::endl;
+        }
+        ring_->pop();
+
+        if (!drainHandler_) continue;
+        ++framesSinceDrain;
+        auto now = std::chrono::steady_clock::now();
+        if (!ring_->front() || framesSinceDrain >= drainMaxFrames_ || now - lastDrain >= drainMaxDelay_) {
+            framesSinceDrain = 0;
+            lastDrain = now;
+            try {
+                drainHandler_();
+            } catch (const std::exception& e) {
+                std::cerr << "Error in compute loop: " << e.what() << std::endl;
+            }
+        }
+    }
+}
+
 void WebSocketClient::handleError(const beast::error_code& ec, const char* what) {
     std::cerr << what << ": " << ec.message() << " (code: " << ec << ")" << std::endl;
     isConnected_ = false;
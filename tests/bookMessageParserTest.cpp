@@ -0,0 +1,159 @@
+// BookMessageParser: snapshots, deltas, conflation, trade frames, and frames
+// that carry no book levels (acks, events) leaving the book untouched.
+#include "bookMessageParser.hpp"
+#include "testSupport.hpp"
+#include <vector>
+
+namespace {
+
+const char* kSnapshot =
+    R"({"action":"snapshot","data":[{"ts":"1597026383085",)"
+    R"("asks":[["100.2","1","0","1"],["100.3","2","0","1"]],)"
+    R"("bids":[["100.0","3","0","1"],["99.9","4","0","1"]]}]})";
+
+// Levels of both sides as (price, quantity) pairs, best first
+std::vector<std::pair<double, double>> levels(const OrderBook& book) {
+    std::vector<std::pair<double, double>> out;
+    for (const auto& level : book.getAsks()) out.emplace_back(level.price, level.quantity);
+    for (const auto& level : book.getBids()) out.emplace_back(-level.price, level.quantity);
+    return out;
+}
+
+// Applied one by one, then conflated into a single flush: same book either way
+void checkConflatedMatchesDirect(const std::vector<const char*>& frames) {
+    OrderBook direct("OKX", "BTC-USDT-SWAP", 0.1), conflated("OKX", "BTC-USDT-SWAP", 0.1);
+    BookMessageParser directParser(direct), conflatingParser(conflated);
+    conflatingParser.setConflation(true);
+    for (const char* frame : frames) {
+        REQUIRE(directParser.process(frame));
+        REQUIRE(conflatingParser.process(frame));
+    }
+    REQUIRE(conflatingParser.flush());
+    CHECK(levels(direct) == levels(conflated));
+    CHECK_EQ(conflatingParser.getStats().conflatedMessages, frames.size() - 1);
+}
+
+} // namespace
+
+TEST(BookMessageParser, AppliesSnapshotAndDelta) {
+    OrderBook book("OKX", "BTC-USDT-SWAP", 0.1);
+    BookMessageParser parser(book);
+    REQUIRE(parser.process(kSnapshot));
+    CHECK_NEAR(book.getBestAsk()->price, 100.2, 1e-9);
+    CHECK_NEAR(book.getBestBid()->price, 100.0, 1e-9);
+
+    REQUIRE(parser.process(R"({"action":"update","data":[{"ts":"1597026383086",)"
+                           R"("asks":[["100.2","0","0","0"]],"bids":[["100.1","5","0","1"]]}]})"));
+    CHECK_NEAR(book.getBestAsk()->price, 100.3, 1e-9);
+    CHECK_NEAR(book.getBestBid()->price, 100.1, 1e-9);
+    CHECK_EQ(book.getBestBid()->quantity, 5.0);
+}
+
+TEST(BookMessageParser, IgnoresFramesWithoutLevels) {
+    OrderBook book("OKX", "BTC-USDT-SWAP", 0.1);
+    BookMessageParser parser(book);
+    REQUIRE(parser.process(kSnapshot));
+
+    CHECK(!(parser.process(R"({"event":"subscribe","arg":{"channel":"books","instId":"BTC-USDT-SWAP"}})")));
+    CHECK(!(parser.process(R"({"event":"error","code":"60012","msg":"Invalid request"})")));
+    CHECK_EQ(parser.getStats().ignored, 2u);
+    CHECK_EQ(parser.getStats().errors, 0u);
+    REQUIRE(book.getBestBid());
+    REQUIRE(book.getBestAsk());
+
+    // Conflating: an ack must not be staged as an empty snapshot either
+    parser.setConflation(true);
+    CHECK(!(parser.process(R"({"event":"subscribe"})")));
+    CHECK(!(parser.flush()));
+    CHECK(book.getBestBid());
+}
+
+TEST(BookMessageParser, RejectsMalformedFrames) {
+    OrderBook book("OKX", "BTC-USDT-SWAP", 0.1);
+    BookMessageParser parser(book);
+    REQUIRE(parser.process(kSnapshot));
+    CHECK(!(parser.process(R"({"asks":[["100.2"]],"bids":[]})")));
+    CHECK(!(parser.process(R"({"asks":[["abc","1"]],"bids":[]})")));
+    CHECK(!(parser.process("not json")));
+    CHECK_EQ(parser.getStats().errors, 3u);
+    CHECK_NEAR(book.getBestAsk()->price, 100.2, 1e-9);
+}
+
+TEST(BookMessageParser, ConflationKeepsLatestQuantityPerLevel) {
+    OrderBook book("OKX", "BTC-USDT-SWAP", 0.1);
+    BookMessageParser parser(book);
+    parser.setConflation(true);
+    REQUIRE(parser.process(kSnapshot));
+    REQUIRE(parser.process(R"({"action":"update","asks":[["100.2","7","0","1"]],"bids":[]})"));
+    REQUIRE(parser.process(R"({"action":"update","asks":[["100.2","8","0","1"]],"bids":[]})"));
+    CHECK(!(book.getBestAsk()));
+
+    REQUIRE(parser.flush());
+    CHECK_EQ(book.getBestAsk()->quantity, 8.0);
+    CHECK_EQ(parser.getStats().conflatedMessages, 2u);
+}
+
+TEST(BookMessageParser, ConflationMergesAddsAndDeletesAcrossLevels) {
+    checkConflatedMatchesDirect({
+        kSnapshot,
+        // Delete then re-add one level, add then delete another, touch a third
+        R"({"action":"update","asks":[["100.2","0","0","0"],["100.5","3","0","1"]],"bids":[["99.8","1","0","1"]]})",
+        R"({"action":"update","asks":[["100.2","6","0","1"],["100.5","0","0","0"]],"bids":[["100.0","0","0","0"]]})",
+        R"({"action":"update","asks":[["100.3","9","0","1"]],"bids":[["99.8","2","0","1"],["99.9","0","0","0"]]})",
+    });
+}
+
+TEST(BookMessageParser, StagedSnapshotSupersedesEarlierDeltas) {
+    checkConflatedMatchesDirect({
+        kSnapshot,
+        R"({"action":"update","asks":[["100.4","5","0","1"]],"bids":[["100.0","0","0","0"]]})",
+        // Only the levels below survive: the deltas above must not leak into it
+        R"({"action":"snapshot","asks":[["101.0","1","0","1"]],"bids":[["99.0","2","0","1"]]})",
+        R"({"action":"update","asks":[["101.1","4","0","1"]],"bids":[["99.0","0","0","0"],["98.9","3","0","1"]]})",
+    });
+
+    OrderBook book("OKX", "BTC-USDT-SWAP", 0.1);
+    BookMessageParser parser(book);
+    parser.setConflation(true);
+    REQUIRE(parser.process(kSnapshot));
+    REQUIRE(parser.process(R"({"action":"update","asks":[["100.4","5","0","1"]],"bids":[]})"));
+    REQUIRE(parser.process(R"({"action":"snapshot","asks":[["101.0","1","0","1"]],"bids":[["99.0","2","0","1"]]})"));
+    REQUIRE(parser.flush());
+    CHECK_EQ(book.getAsks().size(), 1u);
+    CHECK_NEAR(book.getBestAsk()->price, 101.0, 1e-9);
+    CHECK(!(parser.flush()));
+}
+
+TEST(BookMessageParser, PassesTradesToHandler) {
+    OrderBook book("OKX", "BTC-USDT-SWAP", 0.1);
+    BookMessageParser parser(book);
+    REQUIRE(parser.process(kSnapshot));
+
+    double volume = 0.0, lastTime = 0.0;
+    size_t trades = 0;
+    parser.setTradeHandler([&](double quantity, double timeStamp) {
+        volume += quantity;
+        lastTime = timeStamp;
+        ++trades;
+    });
+    CHECK(!(parser.process(R"({"arg":{"channel":"trades","instId":"BTC-USDT-SWAP"},"data":[)"
+                           R"({"instId":"BTC-USDT-SWAP","tradeId":"1","px":"100.1","sz":"0.5","side":"buy","ts":"1597026383085"},)"
+                           R"({"instId":"BTC-USDT-SWAP","tradeId":"2","px":"100.2","sz":"1.25","side":"sell","ts":"1597026384085"}]})")));
+    CHECK_EQ(trades, 2u);
+    CHECK_NEAR(volume, 1.75, 1e-12);
+    CHECK_NEAR(lastTime, 1597026384.085, 1e-6);
+    CHECK_EQ(parser.getStats().trades, 2u);
+    CHECK_EQ(parser.getStats().ignored, 0u);
+    CHECK_NEAR(book.getBestAsk()->price, 100.2, 1e-9);
+
+    // A trade never borrows the frame's time or a previous trade's
+    CHECK(!(parser.process(R"({"ts":"1597026385085","data":[{"sz":"1"},)"
+                           R"({"sz":"2","ts":"1597026386085"},{"sz":"3","ts":"bogus"},{"sz":"4"}]})")));
+    CHECK_EQ(trades, 3u);
+    CHECK_NEAR(volume, 3.75, 1e-12);
+    CHECK_NEAR(lastTime, 1597026386.085, 1e-6);
+    CHECK_EQ(parser.getStats().droppedTrades, 3u);
+    CHECK_EQ(parser.getStats().errors, 0u);
+}
+
+int main() { return test::runAll(); }
@@ -0,0 +1,91 @@
+// CostSurface: exact values on grid points, log-log interpolation between
+// them, zero cells, and the row and grid refreshing independently.
+#include "costSurface.hpp"
+#include "testSupport.hpp"
+#include <cmath>
+#include <vector>
+
+namespace {
+
+CostSurface::Config smallGrid() {
+    CostSurface::Config config;
+    config.sizeCount = 3;
+    config.minSize = 1.0;
+    config.maxSize = 100.0;
+    config.horizonCount = 2;
+    config.minHorizon = 1.0;
+    config.maxHorizon = 10.0;
+    return config;
+}
+
+// Row a * size, grid b * size^2 / horizon: both exact on log-log axes
+void publishPowerLaws(CostSurface& surface, double a, double b) {
+    std::vector<double> row, grid;
+    for (double size : surface.sizes()) row.push_back(a * size);
+    for (double horizon : surface.horizons()) {
+        for (double size : surface.sizes()) grid.push_back(b * size * size / horizon);
+    }
+    surface.publish(CostSurface::Part::Row, row.data(), {a}, 0.0, 0.0);
+    surface.publish(CostSurface::Part::Grid, grid.data(), {b}, 0.0, 0.0);
+}
+
+} // namespace
+
+TEST(CostSurface, NaNUntilBothPartsPublished) {
+    CostSurface surface;
+    surface.configure(smallGrid());
+    CHECK(std::isnan(surface.lookup(1.0, 1.0)));
+    std::vector<double> row(3, 1.0);
+    surface.publish(CostSurface::Part::Row, row.data(), {}, 0.0, 0.0);
+    CHECK(std::isnan(surface.lookup(1.0, 1.0)));
+}
+
+TEST(CostSurface, InterpolatesPowerLawsExactly) {
+    CostSurface surface;
+    surface.configure(smallGrid());
+    publishPowerLaws(surface, 2.0, 3.0);
+    for (double size : {1.0, 3.0, 10.0, 42.0, 100.0}) {
+        for (double horizon : {1.0, 2.5, 10.0}) {
+            double expected = 2.0 * size + 3.0 * size * size / horizon;
+            CHECK_NEAR(surface.lookup(size, horizon), expected, 1e-9 * expected);
+        }
+    }
+    CHECK_NEAR(surface.lookup(-10.0, 10.0), surface.lookup(10.0, 10.0), 1e-12);
+}
+
+TEST(CostSurface, ZeroCellsInterpolateLinearly) {
+    CostSurface surface;
+    surface.configure(smallGrid());
+    // Row 0 at size 1, 2 at size 10; grid all zero
+    std::vector<double> row = {0.0, 2.0, 2.0}, grid(6, 0.0);
+    surface.publish(CostSurface::Part::Row, row.data(), {}, 0.0, 0.0);
+    surface.publish(CostSurface::Part::Grid, grid.data(), {}, 0.0, 0.0);
+    CHECK_EQ(surface.lookup(1.0, 1.0), 0.0);
+    // Halfway between size 1 and 10 on the log axis
+    CHECK_NEAR(surface.lookup(std::sqrt(10.0), 3.0), 1.0, 1e-12);
+    CHECK_NEAR(surface.lookup(10.0, 3.0), 2.0, 1e-12);
+}
+
+TEST(CostSurface, PartsRefreshIndependently) {
+    CostSurface surface;
+    surface.configure(smallGrid());
+    CHECK(surface.needsRefresh(CostSurface::Part::Row, {1.0}, 0.0));
+    CHECK(surface.needsRefresh(CostSurface::Part::Grid, {1.0}, 0.0));
+    publishPowerLaws(surface, 1.0, 1.0);
+
+    CHECK(!(surface.needsRefresh(CostSurface::Part::Grid, {1.0}, 1.0)));
+    CHECK(!(surface.needsRefresh(CostSurface::Part::Row, {1.0 + 1e-4}, 1.0)));
+    CHECK(surface.needsRefresh(CostSurface::Part::Row, {1.1}, 1.0));
+
+    std::vector<double> row = {5.0, 50.0, 500.0};
+    surface.publish(CostSurface::Part::Row, row.data(), {1.1}, 1.0, 0.0);
+    CHECK_NEAR(surface.lookup(10.0, 10.0), 50.0 + 10.0, 1e-9);
+    CHECK(surface.needsRefresh(CostSurface::Part::Grid, {1.0}, surface.config().maxAge));
+
+    CostSurface::Stats stats = surface.stats();
+    CHECK_EQ(stats.rowRefreshes, 2u);
+    CHECK_EQ(stats.gridRefreshes, 1u);
+    CHECK_EQ(stats.skippedRefreshes, 2u);
+}
+
+int main() { return test::runAll(); }
@@ -0,0 +1,82 @@
+// DecimalParser: rounding to increments at and around tick boundaries, and
+// rejection of text that is not a plain finite decimal.
+#include "decimalParser.hpp"
+#include "testSupport.hpp"
+#include <cmath>
+
+using Status = DecimalParser::Status;
+
+TEST(DecimalParser, ParseUnitsExactMultiples) {
+    DecimalParser parser(0.1);
+    int64_t units = 0;
+    CHECK_EQ(parser.parseUnits("97123.4", units), Status::Ok);
+    CHECK_EQ(units, 971234);
+    CHECK_EQ(parser.parseUnits("97123.40000", units), Status::Ok);
+    CHECK_EQ(units, 971234);
+    CHECK_EQ(parser.parseUnits("97125", units), Status::Ok);
+    CHECK_EQ(units, 971250);
+    CHECK_EQ(parser.parseUnits("-0.3", units), Status::Ok);
+    CHECK_EQ(units, -3);
+}
+
+TEST(DecimalParser, ParseUnitsRoundsHalfAwayFromZero) {
+    DecimalParser parser(0.1);
+    int64_t units = 0;
+    CHECK_EQ(parser.parseUnits("100.05", units), Status::Ok);
+    CHECK_EQ(units, 1001);
+    CHECK_EQ(parser.parseUnits("100.0499999", units), Status::Ok);
+    CHECK_EQ(units, 1000);
+    CHECK_EQ(parser.parseUnits("-100.05", units), Status::Ok);
+    CHECK_EQ(units, -1001);
+
+    DecimalParser halves(0.5);
+    CHECK_EQ(halves.parseUnits("0.25", units), Status::Ok);
+    CHECK_EQ(units, 1);
+    CHECK_EQ(halves.parseUnits("0.24", units), Status::Ok);
+    CHECK_EQ(units, 0);
+    CHECK_EQ(halves.parseUnits("1.75", units), Status::Ok);
+    CHECK_EQ(units, 4);
+}
+
+TEST(DecimalParser, ParseUnitsMatchesRoundingTheDouble) {
+    DecimalParser parser(0.01);
+    for (int cents = 0; cents < 100000; cents += 37) {
+        for (const char* suffix : {"", "4", "5", "6"}) {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%d.%02d%s", cents / 100, cents % 100, suffix);
+            int64_t units = 0;
+            REQUIRE_EQ(parser.parseUnits(text, units), Status::Ok);
+            int64_t expected = cents + (suffix[0] >= '5' ? 1 : 0);
+            CHECK_EQ(units, expected);
+        }
+    }
+}
+
+TEST(DecimalParser, ParseUnitsRejectsMalformed) {
+    DecimalParser parser(0.1);
+    int64_t units = 0;
+    CHECK_EQ(parser.parseUnits("", units), Status::Empty);
+    CHECK(parser.parseUnits("1e3", units) != Status::Ok);
+    CHECK(parser.parseUnits("12a", units) != Status::Ok);
+    CHECK(parser.parseUnits("1.2.3", units) != Status::Ok);
+}
+
+TEST(DecimalParser, ParseDouble) {
+    double value = 0.0;
+    CHECK_EQ(DecimalParser::parseDouble("0.015", value), Status::Ok);
+    CHECK_EQ(value, 0.015);
+    CHECK_EQ(DecimalParser::parseDouble("+2.5e-3", value), Status::Ok);
+    CHECK_EQ(value, 0.0025);
+    CHECK_EQ(DecimalParser::parseDouble("", value), Status::Empty);
+    CHECK_EQ(DecimalParser::parseDouble("1.5x", value), Status::Invalid);
+    CHECK_EQ(DecimalParser::parseDouble("1e400", value), Status::OutOfRange);
+}
+
+TEST(DecimalParser, ParseDoubleRejectsNonFinite) {
+    double value = 0.0;
+    for (const char* text : {"nan", "NaN", "inf", "-inf", "infinity", "+Infinity"}) {
+        CHECK_EQ(DecimalParser::parseDouble(text, value), Status::Invalid);
+    }
+}
+
+int main() { return test::runAll(); }
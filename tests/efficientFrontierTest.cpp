@@ -0,0 +1,87 @@
+// EfficientFrontier: the lane-batched grid against one closed-form
+// trajectory per cell, threaded or not, and the file round trip including
+// counts whose buffer size would wrap.
+#include "efficientFrontier.hpp"
+#include "marketImpactModel.hpp"
+#include "stateFile.hpp"
+#include "threadPool.hpp"
+#include "testSupport.hpp"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+const char kPath[] = "efficient_frontier_test.frontier";
+
+// Risk aversions from 0 (straight line) over several decades; the count is
+// not a multiple of the lane width, so the tail lanes are covered too
+std::vector<double> riskAversions() {
+    std::vector<double> values = {0.0};
+    for (int i = 0; i < 36; ++i) values.push_back(1e-9 * std::pow(10.0, i / 6.0));
+    return values;
+}
+
+void checkAgainstTrajectories(const MarketImpactModel& model, const EfficientFrontier& frontier,
+                              double totalSize, size_t slices, double price) {
+    for (size_t h = 0; h < frontier.horizonCount(); ++h) {
+        for (size_t r = 0; r < frontier.riskAversionCount(); ++r) {
+            ExecutionTrajectory expected = model.calculateExecutionTrajectory(
+                totalSize, frontier.horizons()[h], frontier.riskAversions()[r], slices, price);
+            size_t cell = frontier.cellIndex(h, r);
+            CHECK_NEAR(frontier.expectedCosts()[cell], expected.expectedCost, 1e-9 * expected.expectedCost);
+            CHECK_NEAR(frontier.variances()[cell], expected.variance, 1e-9 * expected.variance);
+            CHECK_NEAR(frontier.kappas()[cell], expected.kappa, 1e-9 * expected.kappa + 1e-15);
+        }
+    }
+}
+
+} // namespace
+
+TEST(EfficientFrontier, MatchesPerCellTrajectories) {
+    MarketImpactModel model;
+    model.initialize(0.03, 5000.0, 0.1, 0.2);
+    const std::vector<double> horizons = {60.0, 600.0, 3600.0, 6 * 3600.0};
+    const double totalSize = 250.0, price = 30000.0;
+    const size_t slices = 20;
+
+    EfficientFrontier sequential = model.calculateEfficientFrontier(totalSize, riskAversions(), horizons, slices, price);
+    REQUIRE_EQ(sequential.cellCount(), riskAversions().size() * horizons.size());
+    checkAgainstTrajectories(model, sequential, totalSize, slices, price);
+
+    ThreadPool pool(3);
+    EfficientFrontier threaded =
+        model.calculateEfficientFrontier(totalSize, riskAversions(), horizons, slices, price, &pool);
+    CHECK(threaded.buffer() == sequential.buffer());
+}
+
+TEST(EfficientFrontier, SaveLoadRoundTrip) {
+    MarketImpactModel model;
+    model.initialize(0.02, 1e6);
+    EfficientFrontier frontier = model.calculateEfficientFrontier(10.0, riskAversions(), {300.0, 900.0});
+    REQUIRE(frontier.save(kPath));
+
+    EfficientFrontier loaded;
+    REQUIRE(loaded.load(kPath));
+    CHECK_EQ(loaded.riskAversionCount(), frontier.riskAversionCount());
+    CHECK_EQ(loaded.horizonCount(), 2u);
+    CHECK(loaded.buffer() == frontier.buffer());
+    std::remove(kPath);
+}
+
+TEST(EfficientFrontier, RejectsCountsThatWrap) {
+    // 1 + H + 3H wraps to a single value at H = 2^62: the payload would pass
+    // for the whole grid
+    StateWriter writer;
+    writer.write(uint64_t(1));
+    writer.write(uint64_t(1) << 62);
+    double value = 1.0;
+    writer.writeArray(&value, 1);
+    REQUIRE(writer.save(kPath, "QSFRONTR", 1));
+
+    EfficientFrontier frontier;
+    CHECK(!(frontier.load(kPath)));
+    CHECK_EQ(frontier.cellCount(), 0u);
+    std::remove(kPath);
+}
+
+int main() { return test::runAll(); }
@@ -0,0 +1,90 @@
+// MarketEstimator: EWMA of bar-close returns, including returns that span
+// empty bars, the range estimators over their window of bars, and the rolling
+// trade volume.
+#include "marketEstimator.hpp"
+#include "testSupport.hpp"
+#include <cmath>
+
+namespace {
+
+const double kBarsPerDay = 1440.0;   // Default one-minute bars
+
+} // namespace
+
+TEST(MarketEstimator, EwmaOfBarCloseReturns) {
+    MarketEstimator estimator;
+    CHECK_EQ(estimator.estimates().ewmaVolatility, 0.0);
+
+    // Closes alternating by +-1% in log terms: every bar's variance is 1e-4
+    double price = 100.0;
+    for (int bar = 0; bar < 50; ++bar) {
+        price *= std::exp(bar % 2 == 0 ? 0.01 : -0.01);
+        estimator.update(price, bar * 60.0 + 1.0);
+        estimator.update(price, bar * 60.0 + 30.0);
+    }
+    MarketEstimates estimates = estimator.estimates();
+    CHECK_EQ(estimates.completedBars, 49u);
+    CHECK_NEAR(estimates.ewmaVolatility, std::sqrt(1e-4 * kBarsPerDay), 1e-12);
+}
+
+TEST(MarketEstimator, ReturnAcrossEmptyBarsIsSpreadOverThem) {
+    // Bar 0 closes at 100, nothing trades in bars 1-3, bar 4 closes 2% up
+    MarketEstimator estimator;
+    estimator.update(100.0, 10.0);
+    estimator.update(100.0 * std::exp(0.02), 4 * 60.0 + 10.0);
+    estimator.update(100.0 * std::exp(0.02), 5 * 60.0 + 10.0);
+
+    MarketEstimates estimates = estimator.estimates();
+    CHECK_EQ(estimates.completedBars, 2u);
+    // 0.02^2 over 4 bars is 1e-4 per bar, not 4e-4 in one
+    CHECK_NEAR(estimates.ewmaVolatility, std::sqrt(1e-4 * kBarsPerDay), 1e-12);
+
+    // Adjacent bars are not scaled: bar 5 closes another 2% up
+    estimator.update(100.0 * std::exp(0.04), 5 * 60.0 + 20.0);
+    estimator.update(100.0 * std::exp(0.04), 6 * 60.0 + 10.0);
+    const double decay = estimator.config().ewmaDecay;
+    double variance = decay * 1e-4 + (1.0 - decay) * 4e-4;
+    CHECK_NEAR(estimator.estimates().ewmaVolatility, std::sqrt(variance * kBarsPerDay), 1e-12);
+}
+
+TEST(MarketEstimator, RangeEstimatorsOverTheirWindow) {
+    MarketEstimator::Config config;
+    config.rangeBars = 2;
+    MarketEstimator estimator(config);
+
+    // Open 100, high 102, low 99, close 101
+    for (double price : {100.0, 102.0, 99.0, 101.0}) estimator.update(price, 5.0);
+    estimator.update(101.0, 65.0);
+
+    const double highLow = std::log(102.0 / 99.0), closeOpen = std::log(101.0 / 100.0);
+    const double log2 = std::log(2.0);
+    MarketEstimates estimates = estimator.estimates();
+    CHECK_NEAR(estimates.parkinsonVolatility, std::sqrt(highLow * highLow / (4.0 * log2) * kBarsPerDay), 1e-12);
+    CHECK_NEAR(estimates.garmanKlassVolatility,
+               std::sqrt((0.5 * highLow * highLow - (2.0 * log2 - 1.0) * closeOpen * closeOpen) * kBarsPerDay),
+               1e-12);
+
+    // Two flat bars push the wide one out of the window
+    estimator.update(101.0, 125.0);
+    estimator.update(101.0, 185.0);
+    estimates = estimator.estimates();
+    CHECK_EQ(estimates.parkinsonVolatility, 0.0);
+    CHECK_EQ(estimates.garmanKlassVolatility, 0.0);
+    CHECK_EQ(estimates.completedBars, 3u);
+}
+
+TEST(MarketEstimator, RollingTradeVolume) {
+    MarketEstimator estimator;
+    CHECK_EQ(estimator.estimates().dailyVolume, 0.0);
+    estimator.addTrade(10.0, 0.0);
+    estimator.addTrade(10.0, 3600.0);
+    estimator.addTrade(-4.0, 3600.0);   // Not a quantity
+    // One hour covered so far, extrapolated to a day
+    CHECK_NEAR(estimator.estimates().dailyVolume, 20.0 * 24.0, 1e-9);
+
+    // A day later the first trade has left the window
+    estimator.addTrade(5.0, 86400.0 + 1800.0);
+    CHECK_NEAR(estimator.estimates().dailyVolume, 15.0, 1e-9);
+}
+
+int main() { return test::runAll(); }
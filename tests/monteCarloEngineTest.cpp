@@ -0,0 +1,120 @@
+// Philox known-answer vectors and MonteCarloEngine reproducibility and
+// agreement with the closed-form Almgren-Chriss moments.
+#include "monteCarloEngine.hpp"
+#include "marketImpactModel.hpp"
+#include "philox.hpp"
+#include "threadPool.hpp"
+#include "testSupport.hpp"
+#include <cmath>
+
+namespace {
+
+struct Fixture {
+    double orderSize = 100.0;
+    double horizon = 1800.0;
+    std::vector<double> trades;
+    double expectedCost = 0.0;
+    double variance = 0.0;
+    MonteCarloEngine::Market market;
+};
+
+Fixture makeFixture() {
+    MarketImpactModel model;
+    model.initialize(0.03, 5000.0, 0.1, 0.2);
+    Fixture f;
+    auto trajectory = model.calculateExecutionTrajectory(f.orderSize, f.horizon, 1e-6, 20, 30000.0);
+    f.trades = trajectory.trades;
+    f.expectedCost = trajectory.expectedCost;
+    f.variance = trajectory.variance;
+    f.market.midPrice = 30000.0;
+    f.market.volatility = 0.03;
+    f.market.dailyVolume = 5000.0;
+    f.market.permanentImpactFactor = 0.1;
+    f.market.temporaryImpactFactor = 0.2;
+    return f;
+}
+
+void expectSame(const CostDistribution& a, const CostDistribution& b) {
+    CHECK_EQ(a.mean, b.mean);
+    CHECK_EQ(a.stdDev, b.stdDev);
+    CHECK_EQ(a.valueAtRisk, b.valueAtRisk);
+    CHECK_EQ(a.expectedShortfall, b.expectedShortfall);
+}
+
+} // namespace
+
+TEST(Philox, KnownAnswers) {
+    // Random123 kat_vectors for philox4x32_10
+    CHECK_EQ(Philox4x32::generate({0, 0, 0, 0}, {0, 0}),
+             (Philox4x32::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    CHECK_EQ(Philox4x32::generate({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}),
+             (Philox4x32::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    CHECK_EQ(Philox4x32::generate({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+             (Philox4x32::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+TEST(Philox, ColumnWiseMatchesScalar) {
+    const Philox4x32::Key key = Philox4x32::keyFromSeed(0x123456789abcdefULL);
+    uint32_t c0[5], c1[5], c2[5], c3[5];
+    for (uint32_t i = 0; i < 5; ++i) {
+        c0[i] = i;
+        c1[i] = 7 * i;
+        c2[i] = 0xffffffffu - i;
+        c3[i] = i << 20;
+    }
+    Philox4x32::generate(c0, c1, c2, c3, 5, key);
+    for (uint32_t i = 0; i < 5; ++i) {
+        auto expected = Philox4x32::generate({i, 7 * i, 0xffffffffu - i, i << 20}, key);
+        CHECK_EQ((Philox4x32::Counter{c0[i], c1[i], c2[i], c3[i]}), expected);
+    }
+}
+
+TEST(MonteCarloEngine, SameSeedSameResultForAnyThreadCount) {
+    Fixture f = makeFixture();
+    MonteCarloEngine::Config config;
+    config.paths = 20000;
+    config.fillProbability = 0.8;
+    f.market.halfSpread = 0.05;
+    f.market.feeRate = 0.0005;
+
+    CostDistribution serial = MonteCarloEngine::simulate(f.orderSize, f.trades, f.horizon, f.market, config);
+    for (size_t threads : {1u, 2u, 3u, 8u}) {
+        ThreadPool pool(threads);
+        expectSame(serial, MonteCarloEngine::simulate(f.orderSize, f.trades, f.horizon, f.market, config, &pool));
+    }
+
+    config.seed = 43;
+    CostDistribution other = MonteCarloEngine::simulate(f.orderSize, f.trades, f.horizon, f.market, config);
+    CHECK(serial.mean != other.mean);
+}
+
+TEST(MonteCarloEngine, MatchesClosedFormMoments) {
+    Fixture f = makeFixture();
+    MonteCarloEngine::Config config;
+    config.paths = 200000;
+    ThreadPool pool;
+    CostDistribution result = MonteCarloEngine::simulate(f.orderSize, f.trades, f.horizon, f.market, config, &pool);
+
+    const double sd = std::sqrt(f.variance);
+    // Four standard errors of the mean, and a few percent on the deviation
+    CHECK_NEAR(result.mean, f.expectedCost, 4.0 * sd / std::sqrt(static_cast<double>(config.paths)));
+    CHECK_NEAR(result.stdDev, sd, 0.02 * sd);
+
+    // Gaussian shortfall: VaR and ES at 95% sit 1.645 and 2.063 deviations out
+    REQUIRE_EQ(result.levels.size(), 2u);
+    CHECK_NEAR(result.valueAtRisk[0], f.expectedCost + 1.645 * sd, 0.05 * sd);
+    CHECK_NEAR(result.expectedShortfall[0], f.expectedCost + 2.063 * sd, 0.05 * sd);
+    CHECK(result.expectedShortfall[0] >= result.valueAtRisk[0]);
+    CHECK(result.valueAtRisk[1] >= result.valueAtRisk[0]);
+}
+
+TEST(MonteCarloEngine, EmptyInputs) {
+    Fixture f = makeFixture();
+    MonteCarloEngine::Config config;
+    config.paths = 0;
+    CostDistribution result = MonteCarloEngine::simulate(f.orderSize, f.trades, f.horizon, f.market, config);
+    CHECK_EQ(result.paths, 0u);
+    CHECK_EQ(result.valueAtRisk.size(), config.levels.size());
+}
+
+int main() { return test::runAll(); }
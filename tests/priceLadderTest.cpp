@@ -0,0 +1,224 @@
+// PriceLadder against a std::map reference: best tracking, per-tick
+// quantities, range volumes and sweep ticks through the Fenwick tree, tracked
+// depth sums, and the sliding window.
+#include "priceLadder.hpp"
+#include "testSupport.hpp"
+#include <cmath>
+#include <map>
+#include <random>
+
+namespace {
+
+// Sum of the reference levels with ticks in [low, high]
+double bruteVolume(const std::map<int64_t, double>& levels, int64_t low, int64_t high) {
+    double volume = 0.0;
+    for (auto it = levels.lower_bound(low); it != levels.end() && it->first <= high; ++it) volume += it->second;
+    return volume;
+}
+
+// Tick of the deepest level reached taking `quantity` from the touch, best first
+bool bruteSweep(const std::map<int64_t, double>& levels, bool isBid, double quantity, int64_t& tick) {
+    double taken = 0.0;
+    auto visit = [&](int64_t levelTick, double levelQuantity) {
+        taken += levelQuantity;
+        tick = levelTick;
+        return taken >= quantity;
+    };
+    if (isBid) {
+        for (auto it = levels.rbegin(); it != levels.rend(); ++it) if (visit(it->first, it->second)) return true;
+    } else {
+        for (auto it = levels.begin(); it != levels.end(); ++it) if (visit(it->first, it->second)) return true;
+    }
+    return false;
+}
+
+void randomUpdates(bool isBid) {
+    PriceLadder ladder(isBid);
+    std::map<int64_t, double> reference;
+    std::mt19937_64 rng(isBid ? 7 : 11);
+    std::uniform_int_distribution<int64_t> tickDist(10000, 12000);
+    std::uniform_int_distribution<int> quantityDist(0, 50);
+
+    for (int step = 0; step < 20000; ++step) {
+        int64_t tick = tickDist(rng);
+        double quantity = quantityDist(rng) < 15 ? 0.0 : quantityDist(rng) * 0.25 + 0.25;
+        ladder.set(tick, quantity);
+        if (quantity > 0.0) reference[tick] = quantity;
+        else reference.erase(tick);
+
+        if (step % 97 != 0) continue;
+        REQUIRE_EQ(ladder.levelCount(), reference.size());
+        if (reference.empty()) continue;
+        REQUIRE_EQ(ladder.bestTick(), isBid ? reference.rbegin()->first : reference.begin()->first);
+
+        int64_t probe = tickDist(rng);
+        auto found = reference.find(probe);
+        CHECK_EQ(ladder.quantityAt(probe), found == reference.end() ? 0.0 : found->second);
+
+        int64_t a = tickDist(rng), b = tickDist(rng);
+        CHECK_NEAR(ladder.volumeBetween(a, b), bruteVolume(reference, std::min(a, b), std::max(a, b)), 1e-9);
+
+        double total = bruteVolume(reference, 0, int64_t(1) << 30);
+        CHECK_NEAR(ladder.totalVolume(), total, 1e-9);
+        double target = total * (quantityDist(rng) / 50.0);
+        int64_t expected = 0, actual = 0;
+        REQUIRE_EQ(ladder.sweepTick(target, actual), bruteSweep(reference, isBid, target, expected));
+        CHECK_EQ(actual, expected);
+    }
+}
+
+// Quantity in the best `depth` reference levels
+double bruteDepthVolume(const std::map<int64_t, double>& levels, bool isBid, size_t depth) {
+    double volume = 0.0;
+    size_t visited = 0;
+    auto visit = [&](double quantity) {
+        volume += quantity;
+        return ++visited == depth;
+    };
+    if (isBid) {
+        for (auto it = levels.rbegin(); it != levels.rend(); ++it) if (visit(it->second)) break;
+    } else {
+        for (auto it = levels.begin(); it != levels.end(); ++it) if (visit(it->second)) break;
+    }
+    return volume;
+}
+
+// Batches of changes in front of, inside and behind the tracked depths, with
+// the sums refreshed once per batch as OrderBook does
+void trackedDepthUpdates(bool isBid) {
+    PriceLadder ladder(isBid);
+    std::map<int64_t, double> reference;
+    std::mt19937_64 rng(isBid ? 5 : 13);
+    std::uniform_int_distribution<int> quantityDist(0, 40);
+    // The side spans 200 ticks: most changes land behind the deepest tracked level
+    std::uniform_int_distribution<int64_t> tickDist(5000, 5200);
+    std::uniform_int_distribution<int> batchDist(1, 6);
+
+    for (int batch = 0; batch < 5000; ++batch) {
+        for (int n = batchDist(rng); n > 0; --n) {
+            int64_t tick = tickDist(rng);
+            double quantity = quantityDist(rng) < 10 ? 0.0 : quantityDist(rng) * 0.5 + 0.5;
+            ladder.set(tick, quantity);
+            if (quantity > 0.0) reference[tick] = quantity;
+            else reference.erase(tick);
+        }
+        ladder.refreshDepthVolumes();
+        for (size_t i = 0; i < PriceLadder::kTrackedDepths.size(); ++i) {
+            REQUIRE_NEAR(ladder.trackedDepthVolume(i),
+                         bruteDepthVolume(reference, isBid, PriceLadder::kTrackedDepths[i]), 1e-9);
+        }
+    }
+}
+
+} // namespace
+
+TEST(PriceLadder, AskRangeAndSweepMatchBruteForce) { randomUpdates(false); }
+
+TEST(PriceLadder, BidRangeAndSweepMatchBruteForce) { randomUpdates(true); }
+
+TEST(PriceLadder, AskTrackedDepthsMatchBruteForce) { trackedDepthUpdates(false); }
+
+TEST(PriceLadder, BidTrackedDepthsMatchBruteForce) { trackedDepthUpdates(true); }
+
+TEST(PriceLadder, TrackedDepthsFollowChangesAtTheBoundary) {
+    PriceLadder ladder(false);
+    for (int64_t tick = 100; tick < 130; ++tick) ladder.set(tick, 1.0);
+    ladder.refreshDepthVolumes();
+    CHECK_EQ(ladder.trackedDepthVolume(2), 20.0);
+
+    // Behind the 20th level: no tracked sum moves
+    ladder.set(125, 7.0);
+    ladder.refreshDepthVolumes();
+    CHECK_EQ(ladder.trackedDepthVolume(2), 20.0);
+
+    // The 20th level itself, then a removal that pulls the 21st level in
+    ladder.set(119, 3.0);
+    ladder.refreshDepthVolumes();
+    CHECK_EQ(ladder.trackedDepthVolume(2), 22.0);
+    ladder.set(101, 0.0);
+    ladder.refreshDepthVolumes();
+    CHECK_EQ(ladder.trackedDepthVolume(0), 5.0);
+    CHECK_EQ(ladder.trackedDepthVolume(2), 22.0);
+    for (int64_t tick = 102; tick < 107; ++tick) ladder.set(tick, 0.0);
+    ladder.refreshDepthVolumes();
+    CHECK_EQ(ladder.trackedDepthVolume(2), 28.0);
+
+    // A new best level shifts every bucket
+    ladder.set(90, 4.0);
+    ladder.refreshDepthVolumes();
+    CHECK_EQ(ladder.trackedDepthVolume(0), 8.0);
+}
+
+TEST(PriceLadder, SweepBeyondTotalFails) {
+    PriceLadder ladder(false);
+    ladder.set(100, 1.0);
+    ladder.set(101, 2.0);
+    int64_t tick = 0;
+    CHECK(ladder.sweepTick(3.0, tick));
+    CHECK_EQ(tick, 101);
+    CHECK(!(ladder.sweepTick(3.5, tick)));
+}
+
+TEST(PriceLadder, ClearLeavesNoResidue) {
+    PriceLadder ladder(false);
+    for (int64_t tick = 0; tick < 100; ++tick) ladder.set(tick, 0.1 * static_cast<double>(tick + 1));
+    ladder.clear();
+    CHECK(ladder.empty());
+    ladder.set(50, 1.0);
+    CHECK_EQ(ladder.levelCount(), 1u);
+    CHECK_EQ(ladder.bestTick(), 50);
+    CHECK_EQ(ladder.volumeBetween(0, 99), 1.0);
+}
+
+TEST(PriceLadder, ClearRemovesResidueOfEmptiedSlots) {
+    // Random quantities added and removed leave rounding residue in the
+    // Fenwick nodes of slots that are empty by the time clear() runs
+    PriceLadder ladder(false);
+    std::mt19937_64 rng(3);
+    std::uniform_real_distribution<double> quantityDist(0.001, 3.0);
+    ladder.set(900, 1.0);
+    for (int step = 0; step < 20000; ++step) {
+        int64_t tick = 1000 + static_cast<int64_t>(rng() % 400);
+        ladder.set(tick, ladder.quantityAt(tick) > 0.0 ? 0.0 : quantityDist(rng));
+    }
+    for (int64_t tick = 1000; tick < 1400; ++tick) ladder.set(tick, 0.0);
+    ladder.clear();
+
+    ladder.set(900, 0.5);
+    ladder.set(1399, 0.25);
+    for (int64_t tick = 901; tick < 1399; ++tick) CHECK_EQ(ladder.volumeBetween(900, tick), 0.5);
+    CHECK_EQ(ladder.volumeBetween(900, 1399), 0.75);
+}
+
+TEST(PriceLadder, CountsLevelsBeyondMaxSpan) {
+    PriceLadder ladder(false);
+    ladder.set(0, 1.0);
+    ladder.set(PriceLadder::kMaxSpan + 5, 1.0);
+    CHECK_EQ(ladder.levelCount(), 1u);
+    CHECK_EQ(ladder.quantityAt(PriceLadder::kMaxSpan + 5), 0.0);
+    CHECK_EQ(ladder.droppedLevels(), 1u);
+}
+
+TEST(PriceLadder, FollowsDriftingTouch) {
+    // A book that walks far away from where it started keeps exact sums
+    PriceLadder ladder(false);
+    std::map<int64_t, double> reference;
+    for (int64_t center = 0; center < 3 * PriceLadder::kMaxSpan; center += 1000) {
+        for (int64_t offset = 0; offset < 20; ++offset) {
+            ladder.set(center + offset * 7, 1.0);
+            reference[center + offset * 7] = 1.0;
+        }
+        // Pull the previous block so the touch moves up with the center
+        for (auto it = reference.begin(); it != reference.end() && it->first < center;) {
+            ladder.set(it->first, 0.0);
+            it = reference.erase(it);
+        }
+    }
+    REQUIRE_EQ(ladder.levelCount(), reference.size());
+    CHECK_EQ(ladder.bestTick(), reference.begin()->first);
+    for (const auto& [tick, quantity] : reference) CHECK_EQ(ladder.quantityAt(tick), quantity);
+    CHECK_EQ(ladder.volumeBetween(reference.begin()->first, reference.rbegin()->first), 20.0);
+    CHECK_EQ(ladder.droppedLevels(), 0u);
+}
+
+int main() { return test::runAll(); }
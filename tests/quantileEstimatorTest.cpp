@@ -0,0 +1,94 @@
+// QuantileEstimator: the exact tree against a sorted copy of the sliding
+// window, and P² markers within a tolerance of the true quantiles.
+#include "quantileEstimator.hpp"
+#include "testSupport.hpp"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <random>
+
+namespace {
+
+const std::vector<double> kTracked = {0.1, 0.5, 0.9, 0.99};
+
+// Linear interpolation between the ranks of a sorted copy
+double sortedQuantile(std::vector<double> values, double q) {
+    std::sort(values.begin(), values.end());
+    double position = q * static_cast<double>(values.size() - 1);
+    size_t lower = static_cast<size_t>(std::floor(position));
+    size_t upper = std::min(lower + 1, values.size() - 1);
+    double fraction = position - static_cast<double>(lower);
+    return values[lower] + fraction * (values[upper] - values[lower]);
+}
+
+} // namespace
+
+TEST(QuantileEstimator, ExactMatchesSortedWindow) {
+    const size_t window = 500;
+    auto estimator = QuantileEstimator::create(QuantileEstimator::Mode::Exact, window, kTracked);
+    std::deque<double> values;
+    std::mt19937_64 rng(3);
+    std::normal_distribution<double> dist(0.0, 1.0);
+
+    for (int step = 0; step < 5000; ++step) {
+        // Repeated values exercise equal keys in the tree
+        double value = step % 10 == 0 ? 0.25 : dist(rng);
+        estimator->insert(value);
+        values.push_back(value);
+        if (values.size() > window) {
+            estimator->remove(values.front());
+            values.pop_front();
+        }
+        if (step % 53 != 0) continue;
+        std::vector<double> copy(values.begin(), values.end());
+        for (double q : {0.0, 0.1, 0.37, 0.5, 0.9, 0.99, 1.0}) {
+            REQUIRE_NEAR(estimator->quantile(q), sortedQuantile(copy, q), 1e-12);
+        }
+    }
+}
+
+TEST(QuantileEstimator, ExactAssignSortedMatchesInserts) {
+    std::vector<double> values;
+    for (int i = 0; i < 257; ++i) values.push_back(std::sin(i) * 10.0);
+    std::vector<double> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+
+    auto built = QuantileEstimator::create(QuantileEstimator::Mode::Exact, 1000, kTracked);
+    built->assignSorted(sorted.data(), sorted.size());
+    for (double q : {0.05, 0.5, 0.95}) {
+        CHECK_NEAR(built->quantile(q), sortedQuantile(values, q), 1e-12);
+    }
+}
+
+TEST(QuantileEstimator, EmptyIsZero) {
+    for (auto mode : {QuantileEstimator::Mode::Exact, QuantileEstimator::Mode::Approximate}) {
+        auto estimator = QuantileEstimator::create(mode, 100, kTracked);
+        CHECK_EQ(estimator->quantile(0.5), 0.0);
+    }
+}
+
+TEST(QuantileEstimator, ApproximateTracksTrueQuantiles) {
+    auto estimator = QuantileEstimator::create(QuantileEstimator::Mode::Approximate, 20000, kTracked);
+    std::mt19937_64 rng(5);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    for (int i = 0; i < 50000; ++i) estimator->insert(dist(rng));
+
+    // Standard normal quantiles
+    CHECK_NEAR(estimator->quantile(0.1), -1.2816, 0.05);
+    CHECK_NEAR(estimator->quantile(0.5), 0.0, 0.05);
+    CHECK_NEAR(estimator->quantile(0.9), 1.2816, 0.05);
+    CHECK_NEAR(estimator->quantile(0.99), 2.3263, 0.15);
+}
+
+TEST(QuantileEstimator, ApproximateFollowsLevelShift) {
+    // After more than a window of new values the old regime is forgotten
+    const size_t window = 2000;
+    auto estimator = QuantileEstimator::create(QuantileEstimator::Mode::Approximate, window, kTracked);
+    std::mt19937_64 rng(9);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    for (size_t i = 0; i < 4 * window; ++i) estimator->insert(dist(rng));
+    for (size_t i = 0; i < 4 * window; ++i) estimator->insert(100.0 + dist(rng));
+    CHECK_NEAR(estimator->quantile(0.5), 100.5, 0.1);
+}
+
+int main() { return test::runAll(); }
@@ -0,0 +1,101 @@
+// Simulator maker/taker probability: side-aware for buys and sells, the same
+// in calculateTradeMetrics and calculateTradeMetricsBatch, and finite on a
+// locked book.
+#include "simulator.hpp"
+#include "bookMessageParser.hpp"
+#include "testSupport.hpp"
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Best bid 100.0, best ask 100.2: mid 100.1, half spread 0.1
+const char kSnapshot[] =
+    R"({"action":"snapshot","data":[{"ts":"1597026383085",)"
+    R"("asks":[["100.2","1","0","1"],["100.3","2","0","1"]],)"
+    R"("bids":[["100.0","3","0","1"],["99.9","4","0","1"]]}]})";
+
+const char kLockedSnapshot[] =
+    R"({"action":"snapshot","data":[{"ts":"1597026383085",)"
+    R"("asks":[["100.1","1","0","1"]],"bids":[["100.1","3","0","1"]]}]})";
+
+BookView viewOf(const char* snapshot) {
+    OrderBook book("OKX", "BTC-USDT-SWAP", 0.1);
+    BookMessageParser parser(book);
+    CHECK(parser.process(snapshot));
+    return book.view();
+}
+
+struct Order {
+    OrderSide side;
+    double limitPrice;
+    double expected;
+};
+
+// calculateTradeMetrics signs the size by side and prices "market" orders
+// itself; the batch takes the side and an infinite (buy) or zero (sell) limit
+void checkBothPaths(Simulator& simulator, const BookView& view, const std::vector<Order>& orders) {
+    std::vector<double> sizes, limits, horizons;
+    std::vector<OrderSide> sides;
+    for (const Order& order : orders) {
+        sizes.push_back(0.5);
+        sides.push_back(order.side);
+        limits.push_back(order.limitPrice);
+        horizons.push_back(60.0);
+    }
+    TradeMetricsBatch batch;
+    simulator.calculateTradeMetricsBatch(sizes.data(), sides.data(), limits.data(), horizons.data(), orders.size(),
+                                         view, batch);
+
+    for (size_t i = 0; i < orders.size(); ++i) {
+        double size = orders[i].side == OrderSide::Buy ? 0.5 : -0.5;
+        DetailedTradeMetrics scalar = simulator.calculateTradeMetrics(size, limits[i], "limit", view, 60.0);
+        CHECK(std::isfinite(scalar.makerTakerRatio));
+        CHECK_NEAR(scalar.makerTakerRatio, orders[i].expected, 1e-12);
+        CHECK_EQ(batch.makerTakerRatio[i], scalar.makerTakerRatio);
+        CHECK_NEAR(batch.expectedFees[i], scalar.expectedFees, 1e-12 * scalar.expectedFees);
+    }
+}
+
+} // namespace
+
+TEST(Simulator, MakerProbabilityFollowsTheSide) {
+    Simulator simulator;
+    simulator.initialize("OKX", "BTC-USDT-SWAP");
+    const BookView view = viewOf(kSnapshot);
+    const double passive = 1.0 / (1.0 + std::exp(-1.0));   // One half spread behind the mid
+    const double aggressive = 1.0 / (1.0 + std::exp(1.0));
+
+    checkBothPaths(simulator, view, {
+        {OrderSide::Buy, 100.0, passive},      // Joins the bid
+        {OrderSide::Sell, 100.2, passive},     // Joins the ask
+        {OrderSide::Buy, 100.2, aggressive},   // Lifts the ask
+        {OrderSide::Sell, 100.0, aggressive},  // Hits the bid
+        {OrderSide::Buy, 100.1, 0.5},
+        {OrderSide::Sell, 100.1, 0.5},
+        {OrderSide::Buy, std::numeric_limits<double>::infinity(), 0.0},
+        {OrderSide::Sell, 0.0, 0.0},
+    });
+
+    // "market" takes liquidity on either side, whatever limit is passed
+    CHECK_EQ(simulator.calculateTradeMetrics(0.5, 99.0, "market", view, 60.0).makerTakerRatio, 0.0);
+    CHECK_EQ(simulator.calculateTradeMetrics(-0.5, 101.0, "market", view, 60.0).makerTakerRatio, 0.0);
+}
+
+TEST(Simulator, MakerProbabilityOnLockedBook) {
+    Simulator simulator;
+    simulator.initialize("OKX", "BTC-USDT-SWAP");
+    const BookView view = viewOf(kLockedSnapshot);
+    REQUIRE_EQ(view.spread, 0.0);
+
+    checkBothPaths(simulator, view, {
+        {OrderSide::Buy, 100.0, 1.0},
+        {OrderSide::Buy, view.midPrice, 0.5},
+        {OrderSide::Buy, 100.2, 0.0},
+        {OrderSide::Sell, 100.2, 1.0},
+        {OrderSide::Sell, view.midPrice, 0.5},
+        {OrderSide::Sell, 100.0, 0.0},
+    });
+}
+
+int main() { return test::runAll(); }
@@ -0,0 +1,123 @@
+// SlippageModel state files: a save/load round trip restores the window and
+// the fitted regression, and files whose sizes do not fit the model are
+// rejected without touching it.
+#include "slippageModel.hpp"
+#include "quantileRegression.hpp"
+#include "testSupport.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+
+namespace {
+
+const char kPath[] = "slippage_model_test.state";
+const char kMagic[9] = "QSSLIPPG";
+const uint32_t kVersion = 1;
+const size_t kQuantileCount = 7;   // getQuantileLevels()
+
+// A model with a full window and a fitted regression
+void fillModel(SlippageModel& model) {
+    std::mt19937_64 rng(17);
+    std::normal_distribution<double> step(0.0, 0.5);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double price = 100.0;
+    for (int i = 0; i < 600; ++i) {
+        price += step(rng);
+        model.update(price, 10.0 + 5.0 * unit(rng), i);
+    }
+    for (int i = 0; i < 400; ++i) {
+        double size = 0.1 + 5.0 * unit(rng);
+        model.addObservation(size, 1e-4 * unit(rng), unit(rng) - 0.5, 1e-4 * size * (1.0 + unit(rng)));
+    }
+}
+
+// Hand-built state file in the writeState layout, with no returns block
+bool writeFile(uint64_t capacity, uint64_t count, uint64_t mode, uint64_t levelCount) {
+    StateWriter writer;
+    writer.write(capacity);
+    writer.write(count);
+    writer.write(mode);
+    std::vector<double> column(count, 100.0);
+    for (int i = 0; i < 3; ++i) writer.writeArray(column.data(), column.size());
+    writer.write(uint64_t(0));
+    writer.write(levelCount);
+    std::vector<double> coefficients(QuantileRegression::kFeatures, 0.0);
+    for (uint64_t i = 0; i < levelCount; ++i) writer.writeArray(coefficients.data(), coefficients.size());
+    return writer.save(kPath, kMagic, kVersion);
+}
+
+} // namespace
+
+TEST(SlippageModel, RoundTripRestoresWindowAndFit) {
+    SlippageModel model(500);
+    model.setQuantileMode(QuantileEstimator::Mode::Exact);
+    fillModel(model);
+    REQUIRE(model.fitRegression());
+    REQUIRE(model.saveModel(kPath));
+
+    SlippageModel loaded;
+    REQUIRE(loaded.loadModel(kPath));
+    CHECK_EQ(loaded.getWindowSize(), 500u);
+    CHECK(loaded.getQuantileMode() == QuantileEstimator::Mode::Exact);
+    CHECK(loaded.isRegressionFitted());
+    // Running sums are rebuilt from the window, so the last bits may differ
+    for (double q : {0.1, 0.5, 0.95}) {
+        CHECK_EQ(loaded.getSlippageQuantile(q), model.getSlippageQuantile(q));
+        double expected = model.predictSlippage(2.0, 100.0, q);
+        CHECK_NEAR(loaded.predictSlippage(2.0, 100.0, q), expected, 1e-12 * std::abs(expected));
+        expected = model.predictRegressionSlippage(2.0, 100.0, 5e-5, 0.1, q);
+        CHECK(expected != 0.0);
+        CHECK_NEAR(loaded.predictRegressionSlippage(2.0, 100.0, 5e-5, 0.1, q), expected, 1e-12 * std::abs(expected));
+    }
+    // Nothing new to fit: the loaded fit is current
+    CHECK(!(loaded.fitRegression()));
+    std::remove(kPath);
+}
+
+TEST(SlippageModel, AcceptsWellFormedHandBuiltFiles) {
+    SlippageModel model;
+    REQUIRE(writeFile(10, 4, 0, 0));
+    CHECK(model.loadModel(kPath));
+    CHECK_EQ(model.getWindowSize(), 10u);
+    CHECK(!(model.isRegressionFitted()));
+
+    REQUIRE(writeFile(10, 4, 1, kQuantileCount));
+    CHECK(model.loadModel(kPath));
+    CHECK(model.getQuantileMode() == QuantileEstimator::Mode::Approximate);
+    CHECK(model.isRegressionFitted());
+    std::remove(kPath);
+}
+
+TEST(SlippageModel, RejectsStateWithBadSizes) {
+    SlippageModel model(200);
+    fillModel(model);
+    REQUIRE(model.fitRegression());
+    const double before = model.predictSlippage(2.0, 100.0);
+
+    struct Case {
+        uint64_t capacity, count, mode, levelCount;
+    };
+    const Case cases[] = {
+        {0, 0, 0, 0},                                  // No window
+        {SlippageModel::kMaxWindowSize + 1, 1, 0, 0},  // Over the cap
+        {10, 11, 0, 0},                                // More points than the window holds
+        {10, 4, 2, 0},                                 // Unknown quantile mode
+        {10, 4, 0, 1},                                 // Fewer levels than tracked quantiles
+        {10, 4, 0, kQuantileCount - 1},
+        {10, 4, 0, kQuantileCount + 1},                // More, up to the snapshot limit
+        {10, 4, 0, 16},
+    };
+    for (const Case& c : cases) {
+        REQUIRE(writeFile(c.capacity, c.count, c.mode, c.levelCount));
+        CHECK(!(model.loadModel(kPath)));
+    }
+
+    // A failed load changes nothing
+    CHECK_EQ(model.getWindowSize(), 200u);
+    CHECK(model.isRegressionFitted());
+    CHECK_EQ(model.predictSlippage(2.0, 100.0), before);
+    std::remove(kPath);
+}
+
+int main() { return test::runAll(); }
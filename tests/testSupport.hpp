@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+// Minimal test support, so the tests build wherever the simulator does. Each
+// test binary registers its cases with TEST, runs them from main() through
+// test::runAll() and exits non-zero if any check failed, which is what ctest
+// reads. CHECK* record a failure and carry on; REQUIRE* also leave the case.
+namespace test {
+
+using Case = void (*)();
+
+inline std::vector<std::pair<const char*, Case>>& cases() {
+    static std::vector<std::pair<const char*, Case>> registered;
+    return registered;
+}
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+struct Registration {
+    Registration(const char* name, Case fn) { cases().emplace_back(name, fn); }
+};
+
+inline bool report(bool ok, const char* file, int line, const char* expression) {
+    if (!ok) {
+        ++failures();
+        std::printf("%s:%d: check failed: %s\n", file, line, expression);
+    }
+    return ok;
+}
+
+inline bool reportNear(double actual, double expected, double tolerance, const char* file, int line,
+                       const char* expression) {
+    bool ok = std::abs(actual - expected) <= tolerance;
+    if (!ok) {
+        ++failures();
+        std::printf("%s:%d: check failed: %s (%.17g vs %.17g, tolerance %g)\n", file, line, expression, actual,
+                    expected, tolerance);
+    }
+    return ok;
+}
+
+inline int runAll() {
+    int failedCases = 0;
+    for (const auto& [name, fn] : cases()) {
+        int before = failures();
+        fn();
+        bool passed = failures() == before;
+        failedCases += passed ? 0 : 1;
+        std::printf("[%s] %s\n", passed ? "  OK  " : " FAIL ", name);
+    }
+    std::printf("%zu cases, %d failed\n", cases().size(), failedCases);
+    return failedCases == 0 ? 0 : 1;
+}
+
+} // namespace test
+
+#define TEST(suite, name)                                                                   \
+    static void suite##_##name();                                                           \
+    static test::Registration suite##_##name##_registration(#suite "." #name, suite##_##name); \
+    static void suite##_##name()
+
+#define CHECK(condition) test::report(static_cast<bool>(condition), __FILE__, __LINE__, #condition)
+#define CHECK_EQ(a, b) test::report((a) == (b), __FILE__, __LINE__, #a " == " #b)
+#define CHECK_NEAR(a, b, tolerance) test::reportNear((a), (b), (tolerance), __FILE__, __LINE__, #a " ~ " #b)
+#define REQUIRE(condition) \
+    do { if (!CHECK(condition)) return; } while (0)
+#define REQUIRE_EQ(a, b) \
+    do { if (!CHECK_EQ(a, b)) return; } while (0)
+#define REQUIRE_NEAR(a, b, tolerance) \
+    do { if (!CHECK_NEAR(a, b, tolerance)) return; } while (0)
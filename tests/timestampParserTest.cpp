@@ -0,0 +1,52 @@
+// TimestampParser: ISO8601 and epoch-millisecond forms, including the cached
+// date path and rejection of malformed text.
+#include "timestampParser.hpp"
+#include "testSupport.hpp"
+
+namespace {
+
+int64_t nanos(const TimestampParser::Timestamp& t) { return t.time_since_epoch().count(); }
+
+} // namespace
+
+TEST(TimestampParser, Iso8601) {
+    TimestampParser parser;
+    TimestampParser::Timestamp t;
+    REQUIRE(parser.parse("2025-01-01T00:00:00Z", t));
+    CHECK_EQ(nanos(t), 1735689600LL * 1000000000LL);
+    REQUIRE(parser.parse("2024-02-29T23:59:59.123456789Z", t));
+    CHECK_EQ(nanos(t), 1709251199LL * 1000000000LL + 123456789LL);
+    REQUIRE(parser.parse("1970-01-01T00:00:00.5Z", t));
+    CHECK_EQ(nanos(t), 500000000LL);
+}
+
+TEST(TimestampParser, CachedDateFollowsDateChanges) {
+    TimestampParser parser;
+    TimestampParser::Timestamp t;
+    REQUIRE(parser.parse("2025-03-10T12:00:00Z", t));
+    REQUIRE(parser.parse("2025-03-10T12:00:01Z", t));
+    CHECK_EQ(nanos(t), 1741608001LL * 1000000000LL);
+    REQUIRE(parser.parse("2025-03-11T12:00:01Z", t));
+    CHECK_EQ(nanos(t), (1741608001LL + 86400) * 1000000000LL);
+}
+
+TEST(TimestampParser, EpochMillis) {
+    TimestampParser parser;
+    TimestampParser::Timestamp t;
+    REQUIRE(parser.parse("1597026383085", t));
+    CHECK_EQ(nanos(t), 1597026383085LL * 1000000LL);
+}
+
+TEST(TimestampParser, RejectsMalformedAndKeepsResult) {
+    TimestampParser parser;
+    TimestampParser::Timestamp t;
+    REQUIRE(parser.parse("1597026383085", t));
+    const int64_t before = nanos(t);
+    for (const char* text : {"", "2025-13-01T00:00:00Z", "2025-01-01 00:00:00", "2025-01-01T25:00:00Z",
+                             "12ab", "2025-01-01T00:00:00"}) {
+        CHECK(!(parser.parse(text, t)));
+        CHECK_EQ(nanos(t), before);
+    }
+}
+
+int main() { return test::runAll(); }
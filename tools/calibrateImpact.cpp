@@ -0,0 +1,318 @@
+// Offline calibration of the market impact factors from recorded executions.
+//
+//   calibrate_impact [--fit-exponent] [--threads N] <fills.csv> <output.params>
+//
+// Each CSV line is one parent order: side,quantity,arrival_mid,fill_price,daily_volume
+// (side is buy/sell or 1/-1; a non-numeric first line is taken as a header).
+// arrival_mid comes from the captured book when the order started, fill_price
+// is the average execution price from real or simulated fills. The relative
+// impact side * (fill_price - arrival_mid) / arrival_mid is fitted as
+//
+//   temporary * (quantity / daily_volume)^exponent + permanent * quantity / daily_volume
+//
+// by least squares with non-negative factors. The exponent stays at 0.5 unless
+// --fit-exponent searches it. Parsing and every pass over the data run on a
+// thread pool; partial sums are reduced in a fixed order, so the result does
+// not depend on the thread count. The output is read by
+// MarketImpactModel::loadParameters (IMPACT_PARAMS in .env).
+#include "decimalParser.hpp"
+#include "mappedFile.hpp"
+#include "marketImpactModel.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Observations per reduction block
+constexpr size_t kBlockSize = 1 << 16;
+
+constexpr double kMinExponent = 0.1;
+constexpr double kMaxExponent = 0.95;   // At 1 the two terms cannot be told apart
+
+// Participation quantity / daily_volume (also as its log), and the relative impact
+struct Observations {
+    std::vector<double> participation;
+    std::vector<double> logParticipation;
+    std::vector<double> impact;
+    size_t skipped = 0;
+};
+
+bool parseSide(std::string_view text, double& side) {
+    if (text == "buy" || text == "1" || text == "+1") {
+        side = 1.0;
+    } else if (text == "sell" || text == "-1") {
+        side = -1.0;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// One line; false if it does not hold a usable observation
+bool parseLine(std::string_view line, double& logParticipation, double& impact) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+    std::array<std::string_view, 5> fields;
+    size_t count = 0;
+    while (count < fields.size()) {
+        size_t comma = line.find(',');
+        fields[count++] = line.substr(0, comma);
+        if (comma == std::string_view::npos) break;
+        line.remove_prefix(comma + 1);
+    }
+    if (count != fields.size()) return false;
+
+    double side, quantity, mid, price, dailyVolume;
+    if (!parseSide(fields[0], side) ||
+        DecimalParser::parseDouble(fields[1], quantity) != DecimalParser::Status::Ok ||
+        DecimalParser::parseDouble(fields[2], mid) != DecimalParser::Status::Ok ||
+        DecimalParser::parseDouble(fields[3], price) != DecimalParser::Status::Ok ||
+        DecimalParser::parseDouble(fields[4], dailyVolume) != DecimalParser::Status::Ok) {
+        return false;
+    }
+    if (quantity <= 0.0 || mid <= 0.0 || price <= 0.0 || dailyVolume <= 0.0) return false;
+
+    logParticipation = std::log(quantity / dailyVolume);
+    impact = side * (price - mid) / mid;
+    return true;
+}
+
+// Split the mapping at line boundaries and parse the pieces in parallel
+Observations parseFile(const MappedFile& file, ThreadPool& pool) {
+    const char* data = reinterpret_cast<const char*>(file.data());
+    const size_t size = file.size();
+
+    size_t pieces = pool.concurrency() * 8;
+    std::vector<size_t> bounds{0};
+    for (size_t i = 1; i < pieces; ++i) {
+        size_t at = std::max(size * i / pieces, bounds.back());
+        const void* newline = at < size ? std::memchr(data + at, '\n', size - at) : nullptr;
+        bounds.push_back(newline ? static_cast<const char*>(newline) - data + 1 : size);
+    }
+    bounds.push_back(size);
+
+    std::vector<Observations> parts(pieces);
+    pool.parallelFor(pieces, [&](size_t piece) {
+        Observations& part = parts[piece];
+        size_t at = bounds[piece];
+        while (at < bounds[piece + 1]) {
+            const void* newline = std::memchr(data + at, '\n', bounds[piece + 1] - at);
+            size_t end = newline ? static_cast<const char*>(newline) - data : bounds[piece + 1];
+            std::string_view line(data + at, end - at);
+            at = end + 1;
+
+            double logParticipation, impact;
+            if (parseLine(line, logParticipation, impact)) {
+                part.participation.push_back(std::exp(logParticipation));
+                part.logParticipation.push_back(logParticipation);
+                part.impact.push_back(impact);
+            } else if (!line.empty() && !(piece == 0 && line.data() == data)) {
+                ++part.skipped;   // The first line may be a header
+            }
+        }
+    });
+
+    Observations all;
+    size_t total = 0;
+    for (const auto& part : parts) total += part.impact.size();
+    all.participation.reserve(total);
+    all.logParticipation.reserve(total);
+    all.impact.reserve(total);
+    for (const auto& part : parts) {
+        all.participation.insert(all.participation.end(), part.participation.begin(), part.participation.end());
+        all.logParticipation.insert(all.logParticipation.end(), part.logParticipation.begin(), part.logParticipation.end());
+        all.impact.insert(all.impact.end(), part.impact.begin(), part.impact.end());
+        all.skipped += part.skipped;
+    }
+    return all;
+}
+
+// Sufficient statistics of the two-feature regression for one exponent:
+// p = participation, t = participation^exponent, y = impact
+struct Moments {
+    double pp = 0.0, pt = 0.0, tt = 0.0;
+    double py = 0.0, ty = 0.0;
+    double y = 0.0, yy = 0.0;
+    size_t count = 0;
+
+    void add(const Moments& other) {
+        pp += other.pp; pt += other.pt; tt += other.tt;
+        py += other.py; ty += other.ty;
+        y += other.y; yy += other.yy;
+        count += other.count;
+    }
+};
+
+Moments accumulate(const Observations& obs, double exponent, ThreadPool& pool) {
+    const size_t n = obs.impact.size();
+    const size_t blocks = (n + kBlockSize - 1) / kBlockSize;
+    std::vector<Moments> partial(blocks);
+
+    pool.parallelFor(blocks, [&](size_t block) {
+        size_t begin = block * kBlockSize, end = std::min(begin + kBlockSize, n);
+        const double* participation = obs.participation.data();
+        const double* logP = obs.logParticipation.data();
+        const double* y = obs.impact.data();
+        double pp = 0.0, pt = 0.0, tt = 0.0, py = 0.0, ty = 0.0, sy = 0.0, yy = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            double p = participation[i];
+            double t = std::exp(exponent * logP[i]);
+            pp += p * p; pt += p * t; tt += t * t;
+            py += p * y[i]; ty += t * y[i];
+            sy += y[i]; yy += y[i] * y[i];
+        }
+        partial[block] = {pp, pt, tt, py, ty, sy, yy, end - begin};
+    });
+
+    Moments total;
+    for (const auto& m : partial) total.add(m);
+    return total;
+}
+
+struct Fit {
+    double permanent = 0.0;
+    double temporary = 0.0;
+    double exponent = 0.5;
+    double sse = 0.0;
+    double rSquared = 0.0;
+};
+
+double sumSquaredErrors(const Moments& m, double permanent, double temporary) {
+    return m.yy - 2.0 * (permanent * m.py + temporary * m.ty) +
+           permanent * permanent * m.pp + 2.0 * permanent * temporary * m.pt + temporary * temporary * m.tt;
+}
+
+// Least squares over (permanent, temporary) >= 0 from the moments
+Fit solve(const Moments& m, double exponent) {
+    Fit best;
+    best.exponent = exponent;
+    best.sse = m.yy;   // Both factors zero
+
+    auto consider = [&](double permanent, double temporary) {
+        if (permanent < 0.0 || temporary < 0.0) return;
+        double sse = sumSquaredErrors(m, permanent, temporary);
+        if (sse < best.sse) {
+            best.permanent = permanent;
+            best.temporary = temporary;
+            best.sse = sse;
+        }
+    };
+
+    double determinant = m.pp * m.tt - m.pt * m.pt;
+    if (determinant > 1e-12 * m.pp * m.tt) {
+        consider((m.tt * m.py - m.pt * m.ty) / determinant, (m.pp * m.ty - m.pt * m.py) / determinant);
+    }
+    if (m.pp > 0.0) consider(m.py / m.pp, 0.0);
+    if (m.tt > 0.0) consider(0.0, m.ty / m.tt);
+
+    double count = static_cast<double>(m.count);
+    double total = m.yy - m.y * m.y / count;
+    best.rSquared = total > 0.0 ? 1.0 - best.sse / total : 0.0;
+    return best;
+}
+
+Fit fitAt(const Observations& obs, double exponent, ThreadPool& pool) {
+    return solve(accumulate(obs, exponent, pool), exponent);
+}
+
+// Coarse grid to bracket the best exponent, then golden-section search
+Fit searchExponent(const Observations& obs, ThreadPool& pool) {
+    constexpr size_t kGrid = 18;
+    std::vector<Fit> grid;
+    for (size_t i = 0; i < kGrid; ++i) {
+        grid.push_back(fitAt(obs, kMinExponent + (kMaxExponent - kMinExponent) * i / (kGrid - 1), pool));
+    }
+    size_t at = std::min_element(grid.begin(), grid.end(),
+                                 [](const Fit& a, const Fit& b) { return a.sse < b.sse; }) - grid.begin();
+    double low = grid[at > 0 ? at - 1 : at].exponent;
+    double high = grid[at + 1 < kGrid ? at + 1 : at].exponent;
+
+    const double ratio = (std::sqrt(5.0) - 1.0) / 2.0;
+    double a = high - ratio * (high - low), b = low + ratio * (high - low);
+    Fit fa = fitAt(obs, a, pool), fb = fitAt(obs, b, pool);
+    while (high - low > 1e-4) {
+        if (fa.sse < fb.sse) {
+            high = b; b = a; fb = fa;
+            a = high - ratio * (high - low);
+            fa = fitAt(obs, a, pool);
+        } else {
+            low = a; a = b; fa = fb;
+            b = low + ratio * (high - low);
+            fb = fitAt(obs, b, pool);
+        }
+    }
+    Fit best = fa.sse < fb.sse ? fa : fb;
+    return best.sse <= grid[at].sse ? best : grid[at];
+}
+
+void usage() {
+    std::fprintf(stderr, "usage: calibrate_impact [--fit-exponent] [--threads N] <fills.csv> <output.params>\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool fitExponent = false;
+    size_t threads = 0;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--fit-exponent") {
+            fitExponent = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.size() != 2) {
+        usage();
+        return 2;
+    }
+
+    ThreadPool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+
+    MappedFile file;
+    if (!file.open(paths[0])) {
+        std::fprintf(stderr, "cannot read %s\n", paths[0].c_str());
+        return 1;
+    }
+    Observations obs = parseFile(file, pool);
+    auto parsed = std::chrono::steady_clock::now();
+    if (obs.impact.size() < 2) {
+        std::fprintf(stderr, "not enough observations in %s (%zu skipped lines)\n", paths[0].c_str(), obs.skipped);
+        return 1;
+    }
+
+    Fit fit = fitExponent ? searchExponent(obs, pool) : fitAt(obs, 0.5, pool);
+    auto fitted = std::chrono::steady_clock::now();
+
+    // Written by the model itself, so the file is exactly what loadParameters reads
+    MarketImpactModel model;
+    model.updateImpactFactors(fit.permanent, fit.temporary, fit.exponent);
+    if (!model.saveParameters(paths[1])) {
+        std::fprintf(stderr, "cannot write %s\n", paths[1].c_str());
+        return 1;
+    }
+
+    using Ms = std::chrono::duration<double, std::milli>;
+    std::printf("observations      %zu (%zu lines skipped)\n", obs.impact.size(), obs.skipped);
+    std::printf("threads           %zu\n", pool.concurrency());
+    std::printf("parse             %.1f ms\n", Ms(parsed - start).count());
+    std::printf("fit               %.1f ms\n", Ms(fitted - parsed).count());
+    std::printf("permanent factor  %.6g\n", fit.permanent);
+    std::printf("temporary factor  %.6g\n", fit.temporary);
+    std::printf("impact exponent   %.4f%s\n", fit.exponent, fitExponent ? "" : " (fixed)");
+    std::printf("r squared         %.4f\n", fit.rSquared);
+    std::printf("wrote %s\n", paths[1].c_str());
+    return 0;
+}